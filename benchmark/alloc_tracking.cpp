@@ -0,0 +1,151 @@
+// Copyright (c) 2016 Tristan Brindle (tcbrindle at gmail dot com)
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include "alloc_tracking.hpp"
+
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+// Each block is preceded by a header giving its size, so that we know how
+// much is being freed when operator delete is called without one. The
+// header is as big as the strictest fundamental alignment, so that the
+// block itself stays suitably aligned.
+constexpr std::size_t header_size = alignof(std::max_align_t);
+
+// Per thread, so that tracking one thread isn't disturbed by another, and
+// so that nothing needs to be atomic. These are trivially initialised, so
+// using them before main() (or during thread start-up) is safe.
+struct tracking_state {
+    bool enabled;
+    std::size_t allocations;
+    std::size_t bytes;
+    long long current;
+    long long peak;
+};
+
+thread_local tracking_state state;
+
+void* allocate(std::size_t size)
+{
+    for (;;) {
+        if (void* block = std::malloc(size + header_size)) {
+            *static_cast<std::size_t*>(block) = size;
+            if (state.enabled) {
+                ++state.allocations;
+                state.bytes += size;
+                state.current += static_cast<long long>(size);
+                if (state.current > state.peak) {
+                    state.peak = state.current;
+                }
+            }
+            return static_cast<char*>(block) + header_size;
+        }
+
+        const std::new_handler handler = std::get_new_handler();
+        if (!handler) {
+            throw std::bad_alloc{};
+        }
+        handler();
+    }
+}
+
+void* allocate_nothrow(std::size_t size) noexcept
+{
+    try {
+        return allocate(size);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void deallocate(void* ptr) noexcept
+{
+    if (!ptr) {
+        return;
+    }
+    void* const block = static_cast<char*>(ptr) - header_size;
+    if (state.enabled) {
+        state.current -= static_cast<long long>(*static_cast<std::size_t*>(block));
+    }
+    std::free(block);
+}
+
+} // end anonymous namespace
+
+namespace bench {
+
+void start_alloc_tracking()
+{
+    state = tracking_state{true, 0, 0, 0, 0};
+}
+
+alloc_stats stop_alloc_tracking()
+{
+    state.enabled = false;
+
+    alloc_stats stats;
+    stats.allocations = state.allocations;
+    stats.bytes = state.bytes;
+    stats.peak_bytes = static_cast<std::size_t>(state.peak);
+    stats.measured = true;
+    return stats;
+}
+
+} // end namespace bench
+
+// The replacements themselves. All of the standard forms are replaced, as
+// some standard libraries don't implement the array and nothrow forms in
+// terms of the plain ones.
+
+void* operator new(std::size_t size)
+{
+    return allocate(size);
+}
+
+void* operator new[](std::size_t size)
+{
+    return allocate(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+    return allocate_nothrow(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+    return allocate_nothrow(size);
+}
+
+void operator delete(void* ptr) noexcept
+{
+    deallocate(ptr);
+}
+
+void operator delete[](void* ptr) noexcept
+{
+    deallocate(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept
+{
+    deallocate(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t) noexcept
+{
+    deallocate(ptr);
+}
+
+void operator delete(void* ptr, const std::nothrow_t&) noexcept
+{
+    deallocate(ptr);
+}
+
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept
+{
+    deallocate(ptr);
+}
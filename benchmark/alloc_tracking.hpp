@@ -0,0 +1,38 @@
+// Copyright (c) 2016 Tristan Brindle (tcbrindle at gmail dot com)
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef TCB_UTF_RANGES_BENCHMARK_ALLOC_TRACKING_HPP_INCLUDED
+#define TCB_UTF_RANGES_BENCHMARK_ALLOC_TRACKING_HPP_INCLUDED
+
+#include <cstddef>
+
+// Counting of heap allocations. The benchmark binary replaces the global
+// operator new and operator delete (see alloc_tracking.cpp) so that every
+// allocation made by the calling thread between start_alloc_tracking() and
+// stop_alloc_tracking() is counted, whichever library makes it.
+
+namespace bench {
+
+/// Heap usage of the calling thread over some period
+struct alloc_stats {
+    /// Number of calls to operator new
+    std::size_t allocations = 0;
+    /// Total bytes requested from operator new
+    std::size_t bytes = 0;
+    /// Greatest number of bytes allocated at any one time, over and above
+    /// what was allocated when tracking started
+    std::size_t peak_bytes = 0;
+    /// Whether these have been measured at all
+    bool measured = false;
+};
+
+/// Starts counting the calling thread's allocations, from zero
+void start_alloc_tracking();
+
+/// Stops counting the calling thread's allocations, and returns the totals
+alloc_stats stop_alloc_tracking();
+
+} // end namespace bench
+
+#endif // TCB_UTF_RANGES_BENCHMARK_ALLOC_TRACKING_HPP_INCLUDED
@@ -1,351 +1,530 @@
-
 // Copyright (c) 2016 Tristan Brindle (tcbrindle at gmail dot com)
 // Distributed under the Boost Software License, Version 1.0. (See accompanying
 // file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
 
-#include <cassert>
-#include <chrono>
-#include <codecvt>
-#include <iostream>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
 #include <fstream>
-#include <locale>
+#include <initializer_list>
+#include <iostream>
 #include <string>
+#include <thread>
+#include <utility>
+#include <vector>
 
-#include "utf8.h"
-
-#include <boost/locale/encoding_utf.hpp>
+#include "conversions.hpp"
+#include "corpus.hpp"
+#include "harness.hpp"
+#include "latency.hpp"
+#include "pipelines.hpp"
+#include "report.hpp"
+#include "scaling.hpp"
 
-#include <tcb/utf_ranges/view/utf_convert.hpp>
-
-#include <tcb/utf_ranges/convert.hpp>
-
-using std::string;
-using std::u16string;
-using std::u32string;
+using namespace bench;
 
 namespace {
 
-struct timer {
-    using clock = std::chrono::high_resolution_clock;
-    using time_point = typename clock::time_point;
-
-    timer() = default;
-
-    template <typename T = std::chrono::milliseconds>
-    T elapsed() const
-    {
-        return std::chrono::duration_cast<T>(clock::now() - start_);
-    }
-
-private:
-    time_point start_ = clock::now();
+const char usage[] =
+R"(Usage: benchmark [OPTIONS] [UTF8FILE...]
+
+Runs the benchmarks on each of the given UTF-8 files, and reports the median
+time per call, the median absolute deviation (as a percentage of the median),
+throughput in GB/s of input and in code points per nanosecond.
+
+If no files are given, the benchmarks are run on generated corpora for each
+of the scripts supported by corpus_generator (ascii, latin1, cyrillic,
+arabic, cjk, emoji and random), so that results from different machines can
+be compared.
+
+Options:
+  --runs N        Number of timed runs per benchmark (default 15)
+  --warmup N      Number of untimed warm-up runs (default 3)
+  --min-time MS   Minimum length of each run in milliseconds (default 20)
+  --cpu N         Pin the benchmark to CPU N
+  --filter STR    Only run benchmarks whose corpus/group/impl name contains STR
+  --counters      Also report hardware performance counters (Linux only):
+                  cycles per byte, instructions per cycle, and branch, L1d
+                  and last-level cache misses per KB of input
+  --allocations   Also report the number of heap allocations per call, the
+                  bytes they request, and the peak heap usage during a call
+  --json FILE     Also write the results, with details of the machine, to FILE
+                  as JSON, for use with benchmark_compare
+  --csv FILE      Also write the results to FILE as CSV
+  --mode MODE     Only run the given set of benchmarks (may be repeated):
+                    conversions  the six encoding conversions, for each
+                                 library
+                    views        each of the other views and I/O adaptors
+                    pipeline     the README's UTF-8 to UTF-16BE file pipeline,
+                                 adding one stage at a time
+                    latency      per-call latency (p50, p99 and p99.9) of
+                                 converting short strings, as an RPC layer
+                                 would; printed only, not written to --json
+                                 or --csv
+                    malformed    decoding of generated corpora containing
+                                 each kind of invalid sequence (truncated,
+                                 overlong, surrogate, lone trail byte and
+                                 bad byte) at 1% and 10%, uniformly random
+                                 bytes, and UTF-16 with lone surrogates
+                    scaling      conversions on 1 to N threads, each with its
+                                 own buffer and splitting one large buffer,
+                                 compared with memcpy on the same threads
+                  The default is to run all of them apart from malformed and
+                  scaling.
+
+Options for the scaling mode:
+  --threads N        Largest number of threads to use (default: the number
+                     of CPUs). With --cpu C, thread i is pinned to CPU C + i.
+  --split-size BYTES Size of the buffer which is split between the threads
+                     (default 67108864). Each thread in the independent
+                     case converts one corpus of --size bytes; make the split
+                     buffer larger than the last-level cache, so that it is
+                     limited by memory bandwidth.
+
+Options for generated corpora:
+  --size BYTES       Approximate size of each corpus (default 1048576)
+  --invalid PERCENT  Percentage of characters to replace with invalid UTF-8
+                     sequences (default 0)
+  --seed N           Seed for the generator (default 1)
+)";
+
+struct text_corpus {
+    std::string name;
+    string u8;
+    u16string u16;
+    u32string u32;
+    // The same, with a byte order mark
+    string u8_bom;
+    u16string u16_bom;
+    // codecvt and cpputf8 throw exceptions on invalid input, so they are
+    // left out for corpora which contain any
+    bool valid = true;
+    // The corpus was built as UTF-16, and is only read in that form
+    bool utf16_input = false;
 };
 
-template <typename Func, typename Arg>
-void time_function_call(Func f, Arg&& arg, int n, string label)
-{
-    timer t;
-    for (int i = 0; i < n; i++) {
-        volatile auto res = f(std::forward<Arg>(arg));
-    }
-    auto e = t.elapsed();
-    std::cout << label << " took " << e.count() << "ms\n";
-}
-
-/*
- * All six codecvt conversion functions
- */
-
-inline
-u16string codecvt_u8_to_u16(const string& u8)
-{
-    using codecvt = std::codecvt_utf8_utf16<char16_t>;
-    return std::wstring_convert<codecvt, char16_t>{}.from_bytes(u8);
-}
-
-inline
-u32string codecvt_u8_to_u32(const string& u8)
-{
-    using codecvt = std::codecvt_utf8<char32_t>;
-    return std::wstring_convert<codecvt, char32_t>{}.from_bytes(u8);
-}
-
-inline
-string codecvt_u16_to_u8(const u16string& u16)
+// Identifies the input the corpus's benchmarks actually read
+std::uint64_t corpus_hash(const text_corpus& c)
 {
-    using codecvt = std::codecvt_utf8_utf16<char16_t>;
-    return std::wstring_convert<codecvt, char16_t>{}.to_bytes(u16);
+    return c.utf16_input ? fnv1a(c.u16.data(), c.u16.size() * sizeof(char16_t))
+                         : fnv1a(c.u8.data(), c.u8.size());
 }
 
-inline
-u32string codecvt_u16_to_u32(const u16string& u16)
+text_corpus make_corpus(std::string name, string u8)
 {
-    // You might expect std::codecvt_utf16<char32_t> to convert between
-    // char16_t and char32_t, but it does not; rather, it operates on
-    // UTF-16 encoded *byte* strings. This is not what we want.
-    // We could try to reinterpret_cast<> our way around the problem, but this
-    // is ugly and error prone. The easiest way is to do the conversion in two
-    // steps, to UTF-8 and then to UTF-32. While this might be "unfair" on
-    // codecvt for benchmark purposes, it does rather demonstrate what a
-    // terrible API it is.
-    const string u8 = codecvt_u16_to_u8(u16);
-    return codecvt_u8_to_u32(u8);
-}
-
-inline
-string codecvt_u32_to_u8(const u32string& u32)
-{
-    using codecvt = std::codecvt_utf8<char32_t>;
-    return std::wstring_convert<codecvt, char32_t>{}.to_bytes(u32);
-}
+    text_corpus c;
+    c.name = std::move(name);
+    c.u8 = std::move(u8);
+    c.valid = utf8::is_valid(c.u8.begin(), c.u8.end());
 
-inline
-u16string codecvt_u32_to_u16(const u32string& u32)
-{
-    // As above, to avoid reinterpret_cast<> and trying to pretend that
-    // a UTF-16 string is really a UTF-16 byte string, we do this in two steps
-    const string u8 = codecvt_u32_to_u8(u32);
-    return codecvt_u8_to_u16(u8);
-}
+    if (c.valid) {
+        c.u16 = cpputf8_u8_to_u16(c.u8);
+        c.u32 = cpputf8_u8_to_u32(c.u8);
+    } else {
+        c.u16 = range_u8_to_u16(c.u8);
+        c.u32 = range_u8_to_u32(c.u8);
+    }
 
-/*
- * All six cpputf8 conversion functions
- */
+    c.u8_bom = "\xEF\xBB\xBF" + c.u8;
+    c.u16_bom = u"\uFEFF" + c.u16;
 
-inline
-u16string cpputf8_u8_to_u16(const string& u8)
-{
-    u16string u16;
-    utf8::utf8to16(std::begin(u8), std::end(u8), std::back_inserter(u16));
-    return u16;
+    return c;
 }
 
-inline
-u32string cpputf8_u8_to_u32(const string& u8)
+text_corpus load_corpus(const std::string& path)
 {
-    u32string u32;
-    utf8::utf8to32(std::begin(u8), std::end(u8), std::back_inserter(u32));
-    return u32;
-}
+    const auto slash = path.find_last_of("/\\");
+    std::ifstream f(path, std::ios::binary);
 
-inline
-string cpputf8_u16_to_u8(const u16string& u16)
-{
-    string u8;
-    utf8::utf16to8(std::begin(u16), std::end(u16), std::back_inserter(u8));
-    return u8;
+    return make_corpus(slash == std::string::npos ? path : path.substr(slash + 1),
+                       string(std::istreambuf_iterator<char>{f},
+                              std::istreambuf_iterator<char>{}));
 }
 
-inline
-u32string cpputf8_u16_to_u32(const u16string& u16)
-{
-    // cpputf8 doesn't support this directly (it is, after all, designed to
-    // handle UTF-8), so we need to do it in two steps
-    const string u8 = cpputf8_u16_to_u8(u16);
-    return cpputf8_u8_to_u32(u8);
-}
+template <typename Out, typename In>
+using conversion_fn = Out (*)(const In&);
 
-inline
-string cpputf8_u32_to_u8(const u32string& u32)
+template <typename Out, typename In>
+void add_conversion(suite& s, const char* group, const text_corpus& c, const In& input,
+                    std::initializer_list<std::pair<const char*, conversion_fn<Out, In>>> impls)
 {
-    string u8;
-    utf8::utf32to8(std::begin(u32), std::end(u32), std::back_inserter(u8));
-    return u8;
-}
+    const std::size_t input_bytes = input.size() * sizeof(input[0]);
 
-inline
-u16string cpputf8_u32_to_u16(const u32string& u32)
-{
-    // As above, we need to do this in two steps
-    const string u8 = cpputf8_u32_to_u8(u32);
-    return cpputf8_u8_to_u16(u8);
+    for (const auto& impl : impls) {
+        const std::string name = impl.first;
+        if (!c.valid && (name.find("codecvt") != std::string::npos ||
+                         name.find("cpputf8") != std::string::npos)) {
+            continue;
+        }
+        const auto fn = impl.second;
+        s.add(group, impl.first, input_bytes, [fn, &input] { return fn(input); });
+    }
 }
 
-/*
- * All six Boost.Locale conversion functions
- */
+// Builds the corpora for the malformed mode: for ASCII (where a decoder
+// would like to stay on its fast path) and CJK (where every character is a
+// multi-byte sequence), the valid text and the same text with each kind of
+// defect. The last corpus is the CJK text as UTF-16 with lone surrogates;
+// its u8 and u32 members are the result of converting that with
+// replacement.
+std::vector<text_corpus> make_malformed_corpora(const corpus_spec& base)
+{
+    const defect defects[] = {defect::truncated, defect::overlong, defect::surrogate,
+                              defect::lone_trail, defect::bad_byte};
+
+    std::vector<text_corpus> corpora;
+    u16string cjk_u16;
+    for (auto kind : {script::ascii, script::cjk}) {
+        corpus_spec spec = base;
+        spec.kind = kind;
+        spec.invalid_percent = 0;
+        corpora.push_back(make_corpus(spec.name(), generate_corpus(spec)));
+        if (kind == script::cjk) {
+            cjk_u16 = corpora.back().u16;
+        }
+
+        for (auto d : defects) {
+            for (double percent : {1.0, 10.0}) {
+                spec.defects = d;
+                spec.invalid_percent = percent;
+                corpora.push_back(make_corpus(spec.name(), generate_corpus(spec)));
+            }
+        }
+    }
 
-inline
-u16string boost_u8_to_u16(const string& u8)
-{
-    return boost::locale::conv::utf_to_utf<char16_t>(u8);
-}
+    corpora.push_back(make_corpus("random-bytes", generate_random_bytes(base.size, base.seed)));
 
-inline
-u32string boost_u8_to_u32(const string& u8)
-{
-    return boost::locale::conv::utf_to_utf<char32_t>(u8);
-}
+    text_corpus c;
+    c.name = "cjk-u16-lonesurrogate1";
+    c.u16 = insert_lone_surrogates(std::move(cjk_u16), 1.0, base.seed);
+    c.u8 = range_u16_to_u8(c.u16);
+    c.u32 = range_u16_to_u32(c.u16);
+    c.u8_bom = "\xEF\xBB\xBF" + c.u8;
+    c.u16_bom = u"\uFEFF" + c.u16;
+    c.valid = false;
+    c.utf16_input = true;
+    corpora.push_back(std::move(c));
 
-inline
-string boost_u16_to_u8(const u16string& u16)
-{
-    return boost::locale::conv::utf_to_utf<char>(u16);
+    return corpora;
 }
 
-inline
-u32string boost_u16_to_u32(const u16string& u16)
-{
-    return boost::locale::conv::utf_to_utf<char32_t>(u16);
-}
+// Only the libraries which accept invalid input, and only the decoding
+// directions which can see it
+void add_malformed_conversions(suite& s, const text_corpus& c, bool from_utf16)
+{
+    if (from_utf16) {
+        add_conversion<string>(s, "u16 to u8", c, c.u16, {
+            {"boost", boost_u16_to_u8},
+            {"range", range_u16_to_u8},
+            {"range view", range_view_u16_to_u8},
+            {"range fused", range_fused_u16_to_u8}
+        });
+
+        add_conversion<u32string>(s, "u16 to u32", c, c.u16, {
+            {"boost", boost_u16_to_u32},
+            {"range", range_u16_to_u32},
+            {"range view", range_view_u16_to_u32},
+            {"range fused", range_fused_u16_to_u32}
+        });
+        return;
+    }
 
-inline
-string boost_u32_to_u8(const u32string& u32)
-{
-    return boost::locale::conv::utf_to_utf<char>(u32);
+    add_conversion<u16string>(s, "u8 to u16", c, c.u8, {
+        {"boost", boost_u8_to_u16},
+        {"range", range_u8_to_u16},
+        {"range view", range_view_u8_to_u16},
+        {"range fused", range_fused_u8_to_u16}
+    });
+
+    add_conversion<u32string>(s, "u8 to u32", c, c.u8, {
+        {"boost", boost_u8_to_u32},
+        {"range", range_u8_to_u32},
+        {"range view", range_view_u8_to_u32},
+        {"range fused", range_fused_u8_to_u32}
+    });
 }
 
-inline
-u16string boost_u32_to_u16(const u32string& u32)
-{
-    return boost::locale::conv::utf_to_utf<char16_t>(u32);
+// Implementations marked with a * don't support the conversion directly,
+// and go via UTF-8
+void add_conversions(suite& s, const text_corpus& c)
+{
+    add_conversion<u16string>(s, "u8 to u16", c, c.u8, {
+        {"codecvt", codecvt_u8_to_u16},
+        {"cpputf8", cpputf8_u8_to_u16},
+        {"boost", boost_u8_to_u16},
+        {"range", range_u8_to_u16},
+        {"range view", range_view_u8_to_u16},
+        {"range fused", range_fused_u8_to_u16}
+    });
+
+    add_conversion<u32string>(s, "u8 to u32", c, c.u8, {
+        {"codecvt", codecvt_u8_to_u32},
+        {"cpputf8", cpputf8_u8_to_u32},
+        {"boost", boost_u8_to_u32},
+        {"range", range_u8_to_u32},
+        {"range view", range_view_u8_to_u32},
+        {"range fused", range_fused_u8_to_u32}
+    });
+
+    add_conversion<string>(s, "u16 to u8", c, c.u16, {
+        {"codecvt", codecvt_u16_to_u8},
+        {"cpputf8", cpputf8_u16_to_u8},
+        {"boost", boost_u16_to_u8},
+        {"range", range_u16_to_u8},
+        {"range view", range_view_u16_to_u8},
+        {"range fused", range_fused_u16_to_u8}
+    });
+
+    add_conversion<u32string>(s, "u16 to u32", c, c.u16, {
+        {"*codecvt", codecvt_u16_to_u32},
+        {"*cpputf8", cpputf8_u16_to_u32},
+        {"boost", boost_u16_to_u32},
+        {"range", range_u16_to_u32},
+        {"range view", range_view_u16_to_u32},
+        {"range fused", range_fused_u16_to_u32}
+    });
+
+    add_conversion<string>(s, "u32 to u8", c, c.u32, {
+        {"codecvt", codecvt_u32_to_u8},
+        {"cpputf8", cpputf8_u32_to_u8},
+        {"boost", boost_u32_to_u8},
+        {"range", range_u32_to_u8},
+        {"range view", range_view_u32_to_u8},
+        {"range fused", range_fused_u32_to_u8}
+    });
+
+    add_conversion<u16string>(s, "u32 to u16", c, c.u32, {
+        {"*codecvt", codecvt_u32_to_u16},
+        {"*cpputf8", cpputf8_u32_to_u16},
+        {"boost", boost_u32_to_u16},
+        {"range", range_u32_to_u16},
+        {"range view", range_view_u32_to_u16},
+        {"range fused", range_fused_u32_to_u16}
+    });
 }
 
-/*
- * All six range conversion functions
- */
-
-inline
-u16string range_u8_to_u16(const string& u8)
+template <typename Out, typename In>
+void run_latency(latency_suite& ls, const std::string& pool_name, const char* group,
+                 const std::vector<In>& pool,
+                 std::initializer_list<std::pair<const char*, conversion_fn<Out, In>>> impls)
 {
-    return tcb::utf_ranges::to_u16string(u8);
+    for (const auto& impl : impls) {
+        ls.run(pool_name, group, impl.first, pool, impl.second);
+    }
 }
 
-inline
-u32string range_u8_to_u32(const string& u8)
-{
-    return tcb::utf_ranges::to_u32string(u8);
+// Pools of 5 to 16 and 5 to 60 byte strings, cut from generated text
+void run_latency_benchmarks(const options& opts, corpus_spec spec)
+{
+    const std::pair<std::size_t, std::size_t> lengths[] = {{5, 16}, {5, 60}};
+    constexpr std::size_t pool_size = 4096;
+
+    latency_suite ls{opts};
+
+    spec.size = 1 << 16;
+    spec.invalid_percent = 0;
+    for (auto kind : {script::ascii, script::latin1, script::cjk}) {
+        spec.kind = kind;
+        const string text = generate_corpus(spec);
+
+        for (const auto& len : lengths) {
+            const std::vector<string> u8 =
+                    make_small_strings(text, len.first, len.second, pool_size, spec.seed);
+            std::vector<u16string> u16;
+            u16.reserve(u8.size());
+            for (const auto& str : u8) {
+                u16.push_back(cpputf8_u8_to_u16(str));
+            }
+
+            const std::string pool_name = spec.name() + " " + std::to_string(len.first) +
+                                          "-" + std::to_string(len.second) + "B";
+
+            run_latency<u16string>(ls, pool_name, "u8 to u16", u8, {
+                {"codecvt", codecvt_u8_to_u16},
+                {"cpputf8", cpputf8_u8_to_u16},
+                {"boost", boost_u8_to_u16},
+                {"range", range_u8_to_u16},
+                {"range fused", range_fused_u8_to_u16}
+            });
+
+            run_latency<string>(ls, pool_name, "u16 to u8", u16, {
+                {"codecvt", codecvt_u16_to_u8},
+                {"cpputf8", cpputf8_u16_to_u8},
+                {"boost", boost_u16_to_u8},
+                {"range", range_u16_to_u8},
+                {"range fused", range_fused_u16_to_u8}
+            });
+        }
+    }
 }
 
-inline
-string range_u16_to_u8(const u16string& u16)
-{
-    return tcb::utf_ranges::to_u8string(u16);
+// ASCII and CJK text, UTF-8 to UTF-16 and back
+void run_scaling_benchmarks(const options& opts, corpus_spec spec, std::size_t split_size,
+                            std::size_t max_threads)
+{
+    for (auto kind : {script::ascii, script::cjk}) {
+        spec.kind = kind;
+        spec.invalid_percent = 0;
+        const string u8 = generate_corpus(spec);
+        const u16string u16 = range_u8_to_u16(u8);
+
+        corpus_spec split_spec = spec;
+        split_spec.size = split_size;
+        const string split_u8 = generate_corpus(split_spec);
+        const u16string split_u16 = range_u8_to_u16(split_u8);
+
+        scaling_benchmark<string, u16string> to_u16{spec.name() + ": u8 to u16", u8, split_u8};
+        to_u16.add("boost", boost_u8_to_u16);
+        to_u16.add("range", range_u8_to_u16);
+        to_u16.add("range fused", range_fused_u8_to_u16);
+        to_u16.run(opts, max_threads);
+
+        scaling_benchmark<u16string, string> to_u8{spec.name() + ": u16 to u8", u16, split_u16};
+        to_u8.add("boost", boost_u16_to_u8);
+        to_u8.add("range", range_u16_to_u8);
+        to_u8.add("range fused", range_fused_u16_to_u8);
+        to_u8.run(opts, max_threads);
+    }
 }
 
-inline
-u32string range_u16_to_u32(const u16string& u16)
-{
-    return tcb::utf_ranges::to_u32string(u16);
-}
+struct config {
+    options opts;
+    corpus_spec spec;
+    std::size_t split_size = 64 << 20;
+    std::size_t max_threads = std::max(std::thread::hardware_concurrency(), 1u);
+    std::vector<std::string> files;
+    std::vector<std::string> modes;
+    std::string json_file;
+    std::string csv_file;
+
+    bool has_mode(const char* mode) const
+    {
+        // These take a long time, and aren't run unless asked for
+        const bool opt_in = std::strcmp(mode, "malformed") == 0 ||
+                            std::strcmp(mode, "scaling") == 0;
+        return (modes.empty() && !opt_in) ||
+               std::find(modes.begin(), modes.end(), mode) != modes.end();
+    }
+};
 
-inline
-string range_u32_to_u8(const u32string& u32)
-{
-    return tcb::utf_ranges::to_u8string(u32);
-}
+// Returns false if the command line doesn't make sense
+bool parse_args(int argc, char** argv, config& cfg)
+{
+    options& opts = cfg.opts;
+    corpus_spec& spec = cfg.spec;
+
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        const bool has_value = i + 1 < argc;
+
+        if (std::strcmp(arg, "--runs") == 0 && has_value) {
+            opts.runs = std::atoi(argv[++i]);
+        } else if (std::strcmp(arg, "--warmup") == 0 && has_value) {
+            opts.warmup_runs = std::atoi(argv[++i]);
+        } else if (std::strcmp(arg, "--min-time") == 0 && has_value) {
+            opts.min_run_time = std::chrono::milliseconds(std::atoi(argv[++i]));
+        } else if (std::strcmp(arg, "--cpu") == 0 && has_value) {
+            opts.cpu = std::atoi(argv[++i]);
+        } else if (std::strcmp(arg, "--filter") == 0 && has_value) {
+            opts.filter = argv[++i];
+        } else if (std::strcmp(arg, "--counters") == 0) {
+            opts.counters = true;
+        } else if (std::strcmp(arg, "--allocations") == 0) {
+            opts.allocations = true;
+        } else if (std::strcmp(arg, "--size") == 0 && has_value) {
+            spec.size = std::strtoull(argv[++i], nullptr, 10);
+        } else if (std::strcmp(arg, "--invalid") == 0 && has_value) {
+            spec.invalid_percent = std::atof(argv[++i]);
+        } else if (std::strcmp(arg, "--seed") == 0 && has_value) {
+            spec.seed = std::strtoull(argv[++i], nullptr, 10);
+        } else if (std::strcmp(arg, "--threads") == 0 && has_value) {
+            cfg.max_threads = std::strtoull(argv[++i], nullptr, 10);
+        } else if (std::strcmp(arg, "--split-size") == 0 && has_value) {
+            cfg.split_size = std::strtoull(argv[++i], nullptr, 10);
+        } else if (std::strcmp(arg, "--json") == 0 && has_value) {
+            cfg.json_file = argv[++i];
+        } else if (std::strcmp(arg, "--csv") == 0 && has_value) {
+            cfg.csv_file = argv[++i];
+        } else if (std::strcmp(arg, "--mode") == 0 && has_value) {
+            cfg.modes.emplace_back(argv[++i]);
+        } else if (std::strncmp(arg, "--", 2) == 0) {
+            return false;
+        } else {
+            cfg.files.emplace_back(arg);
+        }
+    }
 
-inline
-u16string range_u32_to_u16(const u32string& u32)
-{
-    return tcb::utf_ranges::to_u16string(u32);
+    return opts.runs > 0 && opts.warmup_runs >= 0 && cfg.max_threads > 0;
 }
 
-/*
- * All six range view functions
- */
+} // end anonymous namespace
 
-inline
-u16string range_view_u8_to_u16(const string& u8)
+int main(int argc, char** argv)
 {
-    return tcb::utf_ranges::view::utf16(u8);
-}
+    config cfg;
 
-inline
-u32string range_view_u8_to_u32(const string& u8)
-{
-    return tcb::utf_ranges::view::utf32(u8);
-}
+    if (!parse_args(argc, argv, cfg)) {
+        std::cout << usage;
+        return 1;
+    }
 
-inline
-string range_view_u16_to_u8(const u16string& u16)
-{
-    return tcb::utf_ranges::view::utf8(u16);
-}
+    const options& opts = cfg.opts;
 
-inline
-u32string range_view_u16_to_u32(const u16string& u16)
-{
-    return tcb::utf_ranges::view::utf32(u16);
-}
+    if (opts.cpu >= 0 && !pin_to_cpu(opts.cpu)) {
+        std::cerr << "Warning: could not pin to CPU " << opts.cpu << "\n";
+    }
 
-inline
-string range_view_u32_to_u8(const u32string& u32)
-{
-    return tcb::utf_ranges::view::utf8(u32);
-}
+    std::vector<text_corpus> corpora;
+    for (const auto& file : cfg.files) {
+        corpora.push_back(load_corpus(file));
+    }
+    if (cfg.files.empty() && (cfg.has_mode("conversions") || cfg.has_mode("views") ||
+                              cfg.has_mode("pipeline"))) {
+        corpus_spec spec = cfg.spec;
+        for (auto kind : all_scripts()) {
+            spec.kind = kind;
+            corpora.push_back(make_corpus(spec.name(), generate_corpus(spec)));
+        }
+    }
 
-inline
-u16string range_view_u32_to_u16(const u32string& u32)
-{
-    return tcb::utf_ranges::view::utf16(u32);
-}
+    std::vector<text_corpus> malformed;
+    if (cfg.has_mode("malformed")) {
+        malformed = make_malformed_corpora(cfg.spec);
+    }
 
-} // end anonymous namespace
+    suite s{opts};
+    for (const auto& c : corpora) {
+        s.set_corpus(c.name, c.u32.size(), corpus_hash(c));
+        if (cfg.has_mode("conversions")) {
+            add_conversions(s, c);
+        }
+        if (cfg.has_mode("views")) {
+            add_view_benchmarks(s, c.u8, c.u8_bom, c.u16, c.u16_bom);
+        }
+        if (cfg.has_mode("pipeline")) {
+            add_pipeline_benchmarks(s, c.u8_bom);
+        }
+    }
+    for (const auto& c : malformed) {
+        s.set_corpus(c.name, c.u32.size(), corpus_hash(c));
+        add_malformed_conversions(s, c, c.utf16_input);
+    }
+    const std::vector<result> results = s.run();
 
-int main(int argc, char** argv)
-{
-    if (argc < 2) {
-        std::cout << "Usage: benchmark UTF8FILE [ITERATIONS]\n";
-        return 1;
+    if (cfg.has_mode("latency")) {
+        run_latency_benchmarks(opts, cfg.spec);
+    }
+    if (cfg.has_mode("scaling")) {
+        run_scaling_benchmarks(opts, cfg.spec, cfg.split_size, cfg.max_threads);
     }
 
-    const string u8str = [argv] {
-        std::ifstream f(argv[1]);
-        return string(std::istreambuf_iterator<char>{f},
-                      std::istreambuf_iterator<char>{});
-    }();
-
-    const u16string u16str = cpputf8_u8_to_u16(u8str);
-    const u32string u32str = cpputf8_u8_to_u32(u8str);
-
-    const int num_iterations = argc > 2 ? std::atoi(argv[2]) : 1;
-
-
-    // UTF-8 to UTF-16
-    time_function_call(codecvt_u8_to_u16, u8str, num_iterations, "codecvt u8 to u16");
-    time_function_call(cpputf8_u8_to_u16, u8str, num_iterations, "cpputf8 u8 to u16");
-    time_function_call(boost_u8_to_u16, u8str, num_iterations, "boost u8 to u16");
-    time_function_call(range_u8_to_u16, u8str, num_iterations, "range u8 to u16");
-    time_function_call(range_view_u8_to_u16, u8str, num_iterations, "range view u8 to u16");
-    std::cout << "\n";
-
-    // UTF-8 to UTF-32
-    time_function_call(codecvt_u8_to_u32, u8str, num_iterations, "codecvt u8 to u32");
-    time_function_call(cpputf8_u8_to_u32, u8str, num_iterations, "cpputf8 u8 to u32");
-    time_function_call(boost_u8_to_u32, u8str, num_iterations, "boost u8 to u32");
-    time_function_call(range_u8_to_u32, u8str, num_iterations, "range u8 to u32");
-    time_function_call(range_view_u8_to_u32, u8str, num_iterations, "range view u8 to u32");
-    std::cout << "\n";
-
-    // UTF-16 to UTF-8
-    time_function_call(codecvt_u16_to_u8, u16str, num_iterations, "codecvt u16 to u8");
-    time_function_call(cpputf8_u16_to_u8, u16str, num_iterations, "cpputf8 u16 to u8");
-    time_function_call(boost_u16_to_u8, u16str, num_iterations, "boost u16 to u8");
-    time_function_call(range_u16_to_u8, u16str, num_iterations, "range u16 to u8");
-    time_function_call(range_view_u16_to_u8, u16str, num_iterations, "range view u16 to u8");
-    std::cout << "\n";
-
-    // UTF-16 to UTF-32
-    time_function_call(codecvt_u16_to_u32, u16str, num_iterations, "*codecvt u16 to u32");
-    time_function_call(cpputf8_u16_to_u32, u16str, num_iterations, "*cpputf8 u16 to u32");
-    time_function_call(boost_u16_to_u32, u16str, num_iterations, "boost u16 to u32");
-    time_function_call(range_u16_to_u32, u16str, num_iterations, "range u16 to u32");
-    time_function_call(range_view_u16_to_u32, u16str, num_iterations, "range view u16 to u32");
-    std::cout << "\n";
-
-    // UTF-32 to UTF-8
-    time_function_call(codecvt_u32_to_u8, u32str, num_iterations, "codecvt u32 to u8");
-    time_function_call(cpputf8_u32_to_u8, u32str, num_iterations, "cpputf8 u32 to u8");
-    time_function_call(boost_u32_to_u8, u32str, num_iterations, "boost u32 to u8");
-    time_function_call(range_u32_to_u8, u32str, num_iterations, "range u32 to u8");
-    time_function_call(range_view_u32_to_u8, u32str, num_iterations, "range view u32 to u8");
-    std::cout << "\n";
-
-    // UTF-32 to UTF-16
-    time_function_call(codecvt_u32_to_u16, u32str, num_iterations, "*codecvt u32 to u16");
-    time_function_call(cpputf8_u32_to_u16, u32str, num_iterations, "*cpputf8 u32 to u16");
-    time_function_call(boost_u32_to_u16, u32str, num_iterations, "boost u32 to u16");
-    time_function_call(range_u32_to_u16, u32str, num_iterations, "range u32 to u16");
-    time_function_call(range_view_u32_to_u16, u32str, num_iterations, "range view u32 to u16");
-}
\ No newline at end of file
+    const machine_info machine = get_machine_info();
+    if (!cfg.json_file.empty()) {
+        std::ofstream f(cfg.json_file);
+        write_json(f, machine, opts, results);
+    }
+    if (!cfg.csv_file.empty()) {
+        std::ofstream f(cfg.csv_file);
+        write_csv(f, machine, opts, results);
+    }
+}
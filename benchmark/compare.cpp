@@ -0,0 +1,493 @@
+// Copyright (c) 2016 Tristan Brindle (tcbrindle at gmail dot com)
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+
+const char usage[] =
+R"(Usage: benchmark_compare [OPTIONS] OLD.json NEW.json
+
+Compares two sets of results written by benchmark --json, and reports the
+change in median time for each benchmark present in both. A change is only
+flagged if it is both larger than the threshold and statistically
+significant according to a two-sided Mann-Whitney U test on the raw samples.
+
+Heap allocation counts (from benchmark --allocations) don't vary from run
+to run, so any change in the number of allocations or in the bytes
+allocated is reported, whatever the timings did.
+
+Exits with status 1 if any regressions were found.
+
+Options:
+  --threshold PERCENT  Smallest change in median to report (default 2)
+  --alpha P            Significance level (default 0.01)
+  --all                Show every benchmark, not just those which changed
+)";
+
+/*
+ * Just enough JSON to read our own output
+ */
+
+struct json {
+    enum class type { null, boolean, number, string, array, object };
+
+    type t = type::null;
+    bool b = false;
+    double num = 0.0;
+    std::string str;
+    std::vector<json> arr;
+    std::vector<std::pair<std::string, json>> obj;
+
+    const json* find(const std::string& key) const
+    {
+        for (const auto& kv : obj) {
+            if (kv.first == key) {
+                return &kv.second;
+            }
+        }
+        return nullptr;
+    }
+
+    std::string get_string(const std::string& key) const
+    {
+        const json* j = find(key);
+        return j && j->t == type::string ? j->str : std::string{};
+    }
+
+    double get_number(const std::string& key) const
+    {
+        const json* j = find(key);
+        return j && j->t == type::number ? j->num : 0.0;
+    }
+};
+
+class json_parser {
+public:
+    explicit json_parser(const std::string& text)
+        : p_(text.c_str()),
+          end_(text.c_str() + text.size())
+    {}
+
+    json parse()
+    {
+        json j = value();
+        skip_ws();
+        if (p_ != end_) {
+            fail("trailing characters");
+        }
+        return j;
+    }
+
+private:
+    [[noreturn]] void fail(const char* what)
+    {
+        throw std::runtime_error(std::string("JSON parse error: ") + what);
+    }
+
+    void skip_ws()
+    {
+        while (p_ != end_ && (*p_ == ' ' || *p_ == '\n' || *p_ == '\r' || *p_ == '\t')) {
+            ++p_;
+        }
+    }
+
+    void expect(char c)
+    {
+        skip_ws();
+        if (p_ == end_ || *p_ != c) {
+            fail("unexpected character");
+        }
+        ++p_;
+    }
+
+    // Skips a comma between elements of an array or object, if there is one
+    bool next_element()
+    {
+        skip_ws();
+        if (p_ != end_ && *p_ == ',') {
+            ++p_;
+            return true;
+        }
+        return false;
+    }
+
+    bool consume(const char* word)
+    {
+        const std::size_t n = std::strlen(word);
+        if (static_cast<std::size_t>(end_ - p_) >= n && std::strncmp(p_, word, n) == 0) {
+            p_ += n;
+            return true;
+        }
+        return false;
+    }
+
+    json value()
+    {
+        skip_ws();
+        if (p_ == end_) {
+            fail("unexpected end of input");
+        }
+
+        json j;
+        switch (*p_) {
+        case '{':
+            j.t = json::type::object;
+            ++p_;
+            skip_ws();
+            if (p_ != end_ && *p_ == '}') {
+                ++p_;
+                return j;
+            }
+            for (;;) {
+                skip_ws();
+                std::string key = string();
+                expect(':');
+                j.obj.emplace_back(std::move(key), value());
+                if (!next_element()) {
+                    break;
+                }
+            }
+            expect('}');
+            return j;
+        case '[':
+            j.t = json::type::array;
+            ++p_;
+            skip_ws();
+            if (p_ != end_ && *p_ == ']') {
+                ++p_;
+                return j;
+            }
+            for (;;) {
+                j.arr.push_back(value());
+                if (!next_element()) {
+                    break;
+                }
+            }
+            expect(']');
+            return j;
+        case '"':
+            j.t = json::type::string;
+            j.str = string();
+            return j;
+        default:
+            break;
+        }
+
+        if (consume("true")) {
+            j.t = json::type::boolean;
+            j.b = true;
+            return j;
+        }
+        if (consume("false")) {
+            j.t = json::type::boolean;
+            return j;
+        }
+        if (consume("null")) {
+            return j;
+        }
+
+        char* num_end = nullptr;
+        j.num = std::strtod(p_, &num_end);
+        if (num_end == p_) {
+            fail("unexpected character");
+        }
+        j.t = json::type::number;
+        p_ = num_end;
+        return j;
+    }
+
+    std::string string()
+    {
+        if (p_ == end_ || *p_ != '"') {
+            fail("expected string");
+        }
+        ++p_;
+
+        std::string s;
+        while (p_ != end_ && *p_ != '"') {
+            if (*p_ == '\\' && p_ + 1 != end_) {
+                ++p_;
+                switch (*p_) {
+                case 'n': s += '\n'; break;
+                case 't': s += '\t'; break;
+                case 'u':
+                    // We only ever write control characters like this
+                    if (end_ - p_ < 5) {
+                        fail("bad escape");
+                    }
+                    s += static_cast<char>(std::strtol(std::string(p_ + 1, p_ + 5).c_str(),
+                                                       nullptr, 16));
+                    p_ += 4;
+                    break;
+                default: s += *p_; break;
+                }
+            } else {
+                s += *p_;
+            }
+            ++p_;
+        }
+        if (p_ == end_) {
+            fail("unterminated string");
+        }
+        ++p_;
+        return s;
+    }
+
+    const char* p_;
+    const char* end_;
+};
+
+/*
+ * Statistics
+ */
+
+/// Two-sided p-value of the Mann-Whitney U test, using the normal
+/// approximation with a correction for ties. This makes no assumptions about
+/// the distribution of the timings, which are usually far from normal.
+double mann_whitney_p(const std::vector<double>& a, const std::vector<double>& b)
+{
+    const std::size_t n1 = a.size();
+    const std::size_t n2 = b.size();
+    if (n1 == 0 || n2 == 0) {
+        return 1.0;
+    }
+
+    std::vector<std::pair<double, int>> all;
+    all.reserve(n1 + n2);
+    for (double x : a) {
+        all.emplace_back(x, 0);
+    }
+    for (double x : b) {
+        all.emplace_back(x, 1);
+    }
+    std::sort(all.begin(), all.end());
+
+    // Assign ranks, averaging over ties
+    const double n = static_cast<double>(n1 + n2);
+    double rank_sum_a = 0.0;
+    double tie_term = 0.0;
+    for (std::size_t i = 0; i < all.size();) {
+        std::size_t j = i;
+        while (j < all.size() && all[j].first == all[i].first) {
+            ++j;
+        }
+        const double avg_rank = (i + 1 + j) / 2.0;
+        for (std::size_t k = i; k < j; k++) {
+            if (all[k].second == 0) {
+                rank_sum_a += avg_rank;
+            }
+        }
+        const double t = static_cast<double>(j - i);
+        tie_term += t * t * t - t;
+        i = j;
+    }
+
+    const double u = rank_sum_a - n1 * (n1 + 1) / 2.0;
+    const double mean = n1 * n2 / 2.0;
+    const double variance = n1 * n2 / 12.0 * ((n + 1) - tie_term / (n * (n - 1)));
+    if (variance <= 0) {
+        return 1.0;
+    }
+
+    const double z = (std::abs(u - mean) - 0.5) / std::sqrt(variance);
+    return z <= 0 ? 1.0 : std::erfc(z / std::sqrt(2.0));
+}
+
+/*
+ * Comparison
+ */
+
+struct entry {
+    std::string corpus_hash;
+    double median = 0.0;
+    std::vector<double> samples;
+    // Negative if allocations weren't counted
+    double allocations = -1;
+    double alloc_bytes = -1;
+};
+
+using result_map = std::map<std::string, entry>;
+
+json load(const std::string& path)
+{
+    std::ifstream f(path);
+    if (!f) {
+        throw std::runtime_error("could not open " + path);
+    }
+    std::stringstream ss;
+    ss << f.rdbuf();
+    return json_parser(ss.str()).parse();
+}
+
+result_map get_results(const json& doc)
+{
+    result_map results;
+    const json* arr = doc.find("results");
+    if (!arr || arr->t != json::type::array) {
+        throw std::runtime_error("no results found");
+    }
+
+    for (const json& r : arr->arr) {
+        const std::string key = r.get_string("corpus") + "/" + r.get_string("group") +
+                                "/" + r.get_string("impl");
+        entry e;
+        e.corpus_hash = r.get_string("corpus_hash");
+        e.median = r.get_number("median_ns");
+        if (const json* s = r.find("samples_ns")) {
+            for (const json& x : s->arr) {
+                e.samples.push_back(x.num);
+            }
+        }
+        if (const json* a = r.find("allocations")) {
+            e.allocations = a->get_number("count");
+            e.alloc_bytes = a->get_number("bytes");
+        }
+        results[key] = std::move(e);
+    }
+
+    return results;
+}
+
+void print_context_differences(const json& old_doc, const json& new_doc)
+{
+    const json* old_ctx = old_doc.find("context");
+    const json* new_ctx = new_doc.find("context");
+    if (!old_ctx || !new_ctx) {
+        return;
+    }
+
+    for (const char* key : {"host", "cpu", "compiler", "flags", "build_type"}) {
+        const std::string a = old_ctx->get_string(key);
+        const std::string b = new_ctx->get_string(key);
+        if (a != b) {
+            std::cout << "Note: " << key << " differs: \"" << a << "\" vs \"" << b << "\"\n";
+        }
+    }
+}
+
+} // end anonymous namespace
+
+int main(int argc, char** argv)
+{
+    double threshold = 2.0;
+    double alpha = 0.01;
+    bool show_all = false;
+    std::vector<std::string> files;
+
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        const bool has_value = i + 1 < argc;
+
+        if (std::strcmp(arg, "--threshold") == 0 && has_value) {
+            threshold = std::atof(argv[++i]);
+        } else if (std::strcmp(arg, "--alpha") == 0 && has_value) {
+            alpha = std::atof(argv[++i]);
+        } else if (std::strcmp(arg, "--all") == 0) {
+            show_all = true;
+        } else if (std::strncmp(arg, "--", 2) != 0) {
+            files.emplace_back(arg);
+        } else {
+            files.clear();
+            break;
+        }
+    }
+
+    if (files.size() != 2) {
+        std::cout << usage;
+        return 2;
+    }
+
+    json old_doc, new_doc;
+    result_map old_results, new_results;
+    try {
+        old_doc = load(files[0]);
+        new_doc = load(files[1]);
+        old_results = get_results(old_doc);
+        new_results = get_results(new_doc);
+    } catch (const std::exception& ex) {
+        std::cerr << "Error: " << ex.what() << "\n";
+        return 2;
+    }
+
+    print_context_differences(old_doc, new_doc);
+
+    int regressions = 0;
+    int improvements = 0;
+    char buf[512];
+
+    std::snprintf(buf, sizeof(buf), "%-50s %12s %12s %8s %9s  %s\n",
+                  "benchmark", "old (ns)", "new (ns)", "change", "p", "verdict");
+    std::cout << buf;
+
+    for (const auto& kv : old_results) {
+        const auto it = new_results.find(kv.first);
+        if (it == new_results.end()) {
+            if (show_all) {
+                std::cout << kv.first << ": only in " << files[0] << "\n";
+            }
+            continue;
+        }
+
+        const entry& a = kv.second;
+        const entry& b = it->second;
+
+        const double change = a.median > 0 ? 100.0 * (b.median / a.median - 1.0) : 0.0;
+        const double p = mann_whitney_p(a.samples, b.samples);
+
+        const bool allocs_changed = a.allocations >= 0 && b.allocations >= 0 &&
+                                    (a.allocations != b.allocations ||
+                                     a.alloc_bytes != b.alloc_bytes);
+
+        std::string verdict;
+        if (a.corpus_hash != b.corpus_hash) {
+            verdict = "input differs, not compared";
+        } else if (p < alpha && change > threshold) {
+            verdict = "REGRESSION";
+            ++regressions;
+        } else if (p < alpha && change < -threshold) {
+            verdict = "improvement";
+            ++improvements;
+        } else if (!show_all && !allocs_changed) {
+            continue;
+        }
+
+        if (allocs_changed) {
+            std::snprintf(buf, sizeof(buf), "%sallocations %.0f -> %.0f, bytes %.0f -> %.0f",
+                          verdict.empty() ? "" : "; ", a.allocations, b.allocations,
+                          a.alloc_bytes, b.alloc_bytes);
+            verdict += buf;
+        }
+
+        std::snprintf(buf, sizeof(buf), "%-50s %12.1f %12.1f %+7.2f%% %9.2g  %s\n",
+                      kv.first.c_str(), a.median, b.median, change, p, verdict.c_str());
+        std::cout << buf;
+    }
+
+    if (show_all) {
+        for (const auto& kv : new_results) {
+            if (old_results.find(kv.first) == old_results.end()) {
+                std::cout << kv.first << ": only in " << files[1] << "\n";
+            }
+        }
+    }
+
+    std::cout << "\n" << regressions << " regression(s), "
+              << improvements << " improvement(s) "
+              << "(threshold " << threshold << "%, alpha " << alpha << ")\n";
+
+    return regressions > 0 ? 1 : 0;
+}
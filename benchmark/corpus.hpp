@@ -0,0 +1,346 @@
+// Copyright (c) 2016 Tristan Brindle (tcbrindle at gmail dot com)
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef TCB_UTF_RANGES_BENCHMARK_CORPUS_HPP_INCLUDED
+#define TCB_UTF_RANGES_BENCHMARK_CORPUS_HPP_INCLUDED
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// Deterministic generation of UTF-8 benchmark input. The same spec always
+// gives the same bytes, on any machine and with any standard library (which
+// is why we don't use <random>'s distributions, whose output isn't
+// specified), so results from different machines can be compared directly.
+
+namespace bench {
+
+/// The kind of text to generate
+enum class script {
+    ascii,    ///< Plain ASCII prose
+    latin1,   ///< Western European text, with accented letters
+    cyrillic, ///< Russian-like text: mostly two-byte sequences
+    arabic,   ///< Arabic-like text: two-byte sequences
+    cjk,      ///< CJK ideographs: three-byte sequences, few spaces
+    emoji,    ///< ASCII chat text with plenty of supplementary-plane emoji
+    random    ///< Random valid code points, with all lengths equally likely
+};
+
+inline const char* script_name(script s)
+{
+    switch (s) {
+    case script::ascii: return "ascii";
+    case script::latin1: return "latin1";
+    case script::cyrillic: return "cyrillic";
+    case script::arabic: return "arabic";
+    case script::cjk: return "cjk";
+    case script::emoji: return "emoji";
+    case script::random: return "random";
+    }
+    return "unknown";
+}
+
+inline std::vector<script> all_scripts()
+{
+    return {script::ascii, script::latin1, script::cyrillic, script::arabic,
+            script::cjk, script::emoji, script::random};
+}
+
+/// The kind of invalid sequence to insert
+enum class defect {
+    mixed,      ///< Any of the below, chosen at random
+    truncated,  ///< A multi-byte sequence missing its last byte(s)
+    overlong,   ///< An overlong encoding
+    surrogate,  ///< An encoded UTF-16 surrogate
+    lone_trail, ///< A continuation byte with no lead byte
+    bad_byte    ///< A byte which never appears in UTF-8 (F8 to FF)
+};
+
+inline const char* defect_name(defect d)
+{
+    switch (d) {
+    case defect::mixed: return "invalid";
+    case defect::truncated: return "truncated";
+    case defect::overlong: return "overlong";
+    case defect::surrogate: return "surrogate";
+    case defect::lone_trail: return "lonetrail";
+    case defect::bad_byte: return "badbyte";
+    }
+    return "unknown";
+}
+
+/// Everything needed to (re)generate a corpus
+struct corpus_spec {
+    script kind = script::ascii;
+    /// Approximate size of the output, in bytes
+    std::size_t size = 1 << 20;
+    /// Percentage of characters which are replaced by an invalid sequence
+    double invalid_percent = 0.0;
+    /// The kind of invalid sequences to use
+    defect defects = defect::mixed;
+    std::uint64_t seed = 1;
+
+    /// A name for the corpus, e.g. "cjk", "cyrillic-invalid2" or
+    /// "ascii-truncated10"
+    std::string name() const
+    {
+        std::string n = script_name(kind);
+        if (invalid_percent > 0) {
+            char buf[32];
+            std::snprintf(buf, sizeof(buf), "-%s%g", defect_name(defects), invalid_percent);
+            n += buf;
+        }
+        return n;
+    }
+};
+
+/// A small, fast PRNG (SplitMix64) with fully specified output
+class prng {
+public:
+    explicit prng(std::uint64_t seed)
+        : state_(seed)
+    {}
+
+    std::uint64_t next()
+    {
+        std::uint64_t z = (state_ += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+
+    /// Returns a number in [0, n)
+    std::uint32_t below(std::uint32_t n)
+    {
+        return static_cast<std::uint32_t>((next() >> 32) * n >> 32);
+    }
+
+    /// Returns a number in [lo, hi]
+    std::uint32_t between(std::uint32_t lo, std::uint32_t hi)
+    {
+        return lo + below(hi - lo + 1);
+    }
+
+    /// Returns true with the given percentage probability
+    bool percent(double p)
+    {
+        return static_cast<double>(next() >> 11) * (100.0 / 9007199254740992.0) < p;
+    }
+
+private:
+    std::uint64_t state_;
+};
+
+namespace detail {
+
+inline void append_utf8(std::string& out, std::uint32_t c)
+{
+    if (c < 0x80) {
+        out += static_cast<char>(c);
+    } else if (c < 0x800) {
+        out += static_cast<char>(0xC0 | (c >> 6));
+        out += static_cast<char>(0x80 | (c & 0x3F));
+    } else if (c < 0x10000) {
+        out += static_cast<char>(0xE0 | (c >> 12));
+        out += static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (c & 0x3F));
+    } else {
+        out += static_cast<char>(0xF0 | (c >> 18));
+        out += static_cast<char>(0x80 | ((c >> 12) & 0x3F));
+        out += static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (c & 0x3F));
+    }
+}
+
+// Appends one of the usual kinds of invalid UTF-8
+inline void append_invalid(std::string& out, prng& rng, defect d)
+{
+    if (d == defect::mixed) {
+        d = static_cast<defect>(rng.between(1, 5));
+    }
+
+    switch (d) {
+    case defect::truncated:
+        switch (rng.below(3)) {
+        case 0: // Two-byte sequence
+            out += static_cast<char>(rng.between(0xC2, 0xDF));
+            break;
+        case 1: // Three-byte sequence
+            out += static_cast<char>(rng.between(0xE1, 0xEC));
+            out += static_cast<char>(rng.between(0x80, 0xBF));
+            break;
+        default: // Four-byte sequence
+            out += static_cast<char>(0xF0);
+            out += static_cast<char>(0x9F);
+            out += static_cast<char>(rng.between(0x80, 0xBF));
+            break;
+        }
+        break;
+    case defect::overlong:
+        if (rng.below(2)) { // Two-byte encoding of an ASCII character
+            out += static_cast<char>(rng.between(0xC0, 0xC1));
+            out += static_cast<char>(rng.between(0x80, 0xBF));
+        } else { // Three-byte encoding of a two-byte character
+            out += static_cast<char>(0xE0);
+            out += static_cast<char>(rng.between(0x80, 0x9F));
+            out += static_cast<char>(rng.between(0x80, 0xBF));
+        }
+        break;
+    case defect::surrogate:
+        out += static_cast<char>(0xED);
+        out += static_cast<char>(rng.between(0xA0, 0xBF));
+        out += static_cast<char>(rng.between(0x80, 0xBF));
+        break;
+    case defect::lone_trail:
+        out += static_cast<char>(rng.between(0x80, 0xBF));
+        break;
+    default:
+        out += static_cast<char>(rng.between(0xF8, 0xFF));
+        break;
+    }
+}
+
+inline std::uint32_t random_scalar_value(prng& rng)
+{
+    switch (rng.below(4)) {
+    case 0:
+        return rng.between(0x20, 0x7E);
+    case 1:
+        return rng.between(0x80, 0x7FF);
+    case 2: {
+        std::uint32_t c;
+        do {
+            c = rng.between(0x800, 0xFFFD);
+        } while (c >= 0xD800 && c <= 0xDFFF);
+        return c;
+    }
+    default:
+        return rng.between(0x10000, 0x10FFFF);
+    }
+}
+
+// A single "letter" of the given script
+inline std::uint32_t random_letter(script s, prng& rng)
+{
+    // Lower case letters with diacritics, plus a few capitals and sharp s
+    static const std::uint32_t latin1_accented[] = {
+        0xE0, 0xE1, 0xE2, 0xE3, 0xE4, 0xE5, 0xE6, 0xE7, 0xE8, 0xE9, 0xEA, 0xEB,
+        0xEC, 0xED, 0xEE, 0xEF, 0xF1, 0xF2, 0xF3, 0xF4, 0xF5, 0xF6, 0xF8, 0xF9,
+        0xFA, 0xFB, 0xFC, 0xFD, 0xFF, 0xDF, 0xC0, 0xC9, 0xC8, 0xC7, 0xD6, 0xDC
+    };
+    constexpr std::uint32_t num_accented = sizeof(latin1_accented) / sizeof(latin1_accented[0]);
+
+    switch (s) {
+    case script::ascii:
+        return rng.between('a', 'z');
+    case script::latin1:
+        return rng.below(100) < 12
+                ? latin1_accented[rng.below(num_accented)]
+                : rng.between('a', 'z');
+    case script::cyrillic:
+        return rng.between(0x0430, 0x044F);
+    case script::arabic:
+        return rng.between(0x0627, 0x064A);
+    case script::cjk:
+        return rng.between(0x4E00, 0x9FFF);
+    case script::emoji:
+        if (rng.below(100) < 8) {
+            return rng.below(2) ? rng.between(0x1F600, 0x1F64F)
+                                : rng.between(0x1F300, 0x1F5FF);
+        }
+        return rng.between('a', 'z');
+    case script::random:
+        return random_scalar_value(rng);
+    }
+    return 'x';
+}
+
+} // end namespace detail
+
+/// Generates UTF-8 text according to spec. Apart from the random kind,
+/// the output is made of words separated by spaces and punctuation and
+/// broken into lines, so that it looks roughly like real text to a
+/// decoder's branch predictor.
+inline std::string generate_corpus(const corpus_spec& spec)
+{
+    prng rng{spec.seed * 0x100 + static_cast<std::uint64_t>(spec.kind)};
+
+    std::string out;
+    out.reserve(spec.size + 8);
+
+    const auto put = [&](std::uint32_t c) {
+        if (spec.invalid_percent > 0 && rng.percent(spec.invalid_percent)) {
+            detail::append_invalid(out, rng, spec.defects);
+        } else {
+            detail::append_utf8(out, c);
+        }
+    };
+
+    std::size_t line_length = 0;
+
+    while (out.size() < spec.size) {
+        if (spec.kind == script::random) {
+            put(detail::random_scalar_value(rng));
+            continue;
+        }
+
+        // A word
+        const std::uint32_t word_length = rng.between(1, spec.kind == script::cjk ? 12 : 9);
+        for (std::uint32_t i = 0; i < word_length; i++) {
+            put(detail::random_letter(spec.kind, rng));
+        }
+        line_length += word_length;
+
+        // ...followed by punctuation or a space
+        const std::uint32_t r = rng.below(100);
+        if (spec.kind == script::cjk) {
+            put(r < 50 ? 0x3001 : r < 80 ? 0x3002 : ' ');
+        } else if (r < 8) {
+            put(r < 5 ? ',' : '.');
+            put(' ');
+        } else {
+            put(' ');
+        }
+
+        if (line_length > 60) {
+            put('\n');
+            line_length = 0;
+        }
+    }
+
+    return out;
+}
+
+/// Generates uniformly random bytes: the worst case for a UTF-8 decoder,
+/// as about half of the input is invalid and nothing is predictable
+inline std::string generate_random_bytes(std::size_t size, std::uint64_t seed)
+{
+    prng rng{seed};
+    std::string out(size, '\0');
+    for (char& c : out) {
+        c = static_cast<char>(rng.below(256));
+    }
+    return out;
+}
+
+/// Replaces the given percentage of the code units of str with lone
+/// (unpaired) surrogates
+inline std::u16string insert_lone_surrogates(std::u16string str, double percent,
+                                             std::uint64_t seed)
+{
+    prng rng{seed};
+    for (char16_t& c : str) {
+        if (rng.percent(percent)) {
+            c = static_cast<char16_t>(rng.below(2) ? rng.between(0xD800, 0xDBFF)
+                                                   : rng.between(0xDC00, 0xDFFF));
+        }
+    }
+    return str;
+}
+
+} // end namespace bench
+
+#endif // TCB_UTF_RANGES_BENCHMARK_CORPUS_HPP_INCLUDED
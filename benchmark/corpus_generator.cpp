@@ -0,0 +1,112 @@
+// Copyright (c) 2016 Tristan Brindle (tcbrindle at gmail dot com)
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <initializer_list>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "corpus.hpp"
+
+namespace {
+
+const char usage[] =
+R"(Usage: corpus_generator [OPTIONS] OUTDIR
+
+Writes deterministic UTF-8 benchmark corpora to OUTDIR, one file per script:
+ascii, latin1, cyrillic, arabic, cjk, emoji and random. The same options
+always give the same files, on any machine.
+
+Options:
+  --size BYTES       Approximate size of each file (default 1048576)
+  --invalid PERCENT  Percentage of characters to replace with invalid UTF-8
+                     sequences (default 0)
+  --defect KIND      The kind of invalid sequence to use: truncated, overlong,
+                     surrogate, lonetrail or badbyte (default: a mixture)
+  --seed N           Seed for the generator (default 1)
+  --script NAME      Only generate the named script (may be repeated)
+)";
+
+} // end anonymous namespace
+
+int main(int argc, char** argv)
+{
+    bench::corpus_spec base;
+    std::vector<bench::script> scripts;
+    std::string out_dir;
+
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        const bool has_value = i + 1 < argc;
+
+        if (std::strcmp(arg, "--size") == 0 && has_value) {
+            base.size = std::strtoull(argv[++i], nullptr, 10);
+        } else if (std::strcmp(arg, "--invalid") == 0 && has_value) {
+            base.invalid_percent = std::atof(argv[++i]);
+        } else if (std::strcmp(arg, "--defect") == 0 && has_value) {
+            const char* name = argv[++i];
+            bool found = false;
+            for (auto d : {bench::defect::truncated, bench::defect::overlong,
+                           bench::defect::surrogate, bench::defect::lone_trail,
+                           bench::defect::bad_byte}) {
+                if (std::strcmp(name, bench::defect_name(d)) == 0) {
+                    base.defects = d;
+                    found = true;
+                }
+            }
+            if (!found) {
+                std::cerr << "Unknown defect " << name << "\n";
+                return 1;
+            }
+        } else if (std::strcmp(arg, "--seed") == 0 && has_value) {
+            base.seed = std::strtoull(argv[++i], nullptr, 10);
+        } else if (std::strcmp(arg, "--script") == 0 && has_value) {
+            const char* name = argv[++i];
+            bool found = false;
+            for (auto s : bench::all_scripts()) {
+                if (std::strcmp(name, bench::script_name(s)) == 0) {
+                    scripts.push_back(s);
+                    found = true;
+                }
+            }
+            if (!found) {
+                std::cerr << "Unknown script " << name << "\n";
+                return 1;
+            }
+        } else if (std::strncmp(arg, "--", 2) != 0 && out_dir.empty()) {
+            out_dir = arg;
+        } else {
+            std::cout << usage;
+            return 1;
+        }
+    }
+
+    if (out_dir.empty()) {
+        std::cout << usage;
+        return 1;
+    }
+
+    if (scripts.empty()) {
+        scripts = bench::all_scripts();
+    }
+
+    for (auto s : scripts) {
+        bench::corpus_spec spec = base;
+        spec.kind = s;
+
+        const std::string path = out_dir + "/" + spec.name() + ".txt";
+        const std::string text = bench::generate_corpus(spec);
+
+        std::ofstream f(path, std::ios::binary);
+        f.write(text.data(), static_cast<std::streamsize>(text.size()));
+        if (!f) {
+            std::cerr << "Could not write " << path << "\n";
+            return 1;
+        }
+        std::cout << path << ": " << text.size() << " bytes\n";
+    }
+}
@@ -0,0 +1,423 @@
+// Copyright (c) 2016 Tristan Brindle (tcbrindle at gmail dot com)
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef TCB_UTF_RANGES_BENCHMARK_HARNESS_HPP_INCLUDED
+#define TCB_UTF_RANGES_BENCHMARK_HARNESS_HPP_INCLUDED
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#if defined(__linux__)
+#include <sched.h>
+#endif
+
+#include "alloc_tracking.hpp"
+#include "perf_counters.hpp"
+
+namespace bench {
+
+/// Settings which control how each benchmark is run
+struct options {
+    /// Untimed runs before measurement starts, to warm up caches, branch
+    /// predictors and the allocator
+    int warmup_runs = 3;
+    /// Number of timed runs; the median of these is reported
+    int runs = 15;
+    /// Each run repeats the function until at least this much time has
+    /// passed, so that very fast functions are still timed accurately
+    std::chrono::nanoseconds min_run_time = std::chrono::milliseconds(20);
+    /// CPU to pin the benchmark thread to, or -1 to leave it alone
+    int cpu = -1;
+    /// Only run benchmarks whose name contains this string
+    std::string filter;
+    /// Whether to read hardware performance counters during an extra run
+    bool counters = false;
+    /// Whether to count heap allocations during an extra call
+    bool allocations = false;
+};
+
+/// Summary statistics for a set of timed runs. We use the median and the
+/// median absolute deviation rather than the mean and standard deviation,
+/// as timings have a long tail (interrupts, frequency changes, other
+/// processes) which would otherwise swamp the result.
+struct stats {
+    double median = 0.0;
+    double mad = 0.0;
+    double min = 0.0;
+    double max = 0.0;
+    std::size_t samples = 0;
+};
+
+inline double median_of(std::vector<double> v)
+{
+    if (v.empty()) {
+        return 0.0;
+    }
+    const std::size_t mid = v.size() / 2;
+    std::nth_element(v.begin(), v.begin() + mid, v.end());
+    if (v.size() % 2 == 1) {
+        return v[mid];
+    }
+    const double upper = v[mid];
+    const double lower = *std::max_element(v.begin(), v.begin() + mid);
+    return (lower + upper) / 2.0;
+}
+
+inline stats compute_stats(const std::vector<double>& samples)
+{
+    stats s;
+    if (samples.empty()) {
+        return s;
+    }
+
+    s.samples = samples.size();
+    s.median = median_of(samples);
+    s.min = *std::min_element(samples.begin(), samples.end());
+    s.max = *std::max_element(samples.begin(), samples.end());
+
+    std::vector<double> deviations;
+    deviations.reserve(samples.size());
+    for (double x : samples) {
+        deviations.push_back(x > s.median ? x - s.median : s.median - x);
+    }
+    s.mad = median_of(std::move(deviations));
+
+    return s;
+}
+
+/// Prevents the compiler from optimising away the computation of value,
+/// without the cost of copying it anywhere
+template <typename T>
+inline void do_not_optimize(const T& value)
+{
+#if defined(__GNUC__)
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    static volatile const void* sink;
+    sink = &value;
+#endif
+}
+
+/// Pins the calling thread to the given CPU, so that results aren't
+/// disturbed by migrations. Returns false if that isn't possible.
+inline bool pin_to_cpu(int cpu)
+{
+#if defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return sched_setaffinity(0, sizeof(set), &set) == 0;
+#else
+    (void) cpu;
+    return false;
+#endif
+}
+
+using bench_clock = std::chrono::steady_clock;
+
+template <typename Fn>
+std::chrono::nanoseconds time_iterations(Fn& fn, std::size_t iterations)
+{
+    const auto start = bench_clock::now();
+    for (std::size_t i = 0; i < iterations; i++) {
+        do_not_optimize(fn());
+    }
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(bench_clock::now() - start);
+}
+
+/// The timings for one function: nanoseconds per call for each run, and
+/// (if requested) hardware counter values and heap usage per call
+struct measurement {
+    std::size_t iterations_per_run = 0;
+    std::vector<double> ns_per_call;
+    counter_values counters;
+    alloc_stats allocs;
+};
+
+/// Times fn, which is called with no arguments and should return its
+/// result (which is then discarded). The number of calls per run is first
+/// calibrated so that each run lasts at least opts.min_run_time.
+///
+/// If pc is given, one further run is made with the counters enabled. This
+/// is kept separate from the timed runs, so that reading the counters
+/// doesn't disturb the timings. Likewise, if opts.allocations is set, one
+/// final call is made with allocation tracking on; the result is destroyed
+/// before tracking stops, so freeing it is included.
+template <typename Fn>
+measurement measure(Fn&& fn, const options& opts, perf_counters* pc = nullptr)
+{
+    std::size_t iterations = 1;
+    while (time_iterations(fn, iterations) < opts.min_run_time &&
+           iterations < (std::size_t{1} << 30)) {
+        iterations *= 2;
+    }
+
+    for (int i = 0; i < opts.warmup_runs; i++) {
+        time_iterations(fn, iterations);
+    }
+
+    measurement m;
+    m.iterations_per_run = iterations;
+    m.ns_per_call.reserve(opts.runs);
+    for (int i = 0; i < opts.runs; i++) {
+        const auto t = time_iterations(fn, iterations);
+        m.ns_per_call.push_back(static_cast<double>(t.count()) / iterations);
+    }
+
+    if (pc) {
+        pc->start();
+        time_iterations(fn, iterations);
+        m.counters = pc->stop(static_cast<double>(iterations));
+    }
+
+    if (opts.allocations) {
+        start_alloc_tracking();
+        do_not_optimize(fn());
+        m.allocs = stop_alloc_tracking();
+    }
+
+    return m;
+}
+
+/// Formats a duration in nanoseconds using a sensible unit
+inline std::string format_time(double ns)
+{
+    char buf[32];
+    if (ns < 1e3) {
+        std::snprintf(buf, sizeof(buf), "%.1fns", ns);
+    } else if (ns < 1e6) {
+        std::snprintf(buf, sizeof(buf), "%.2fus", ns / 1e3);
+    } else if (ns < 1e9) {
+        std::snprintf(buf, sizeof(buf), "%.2fms", ns / 1e6);
+    } else {
+        std::snprintf(buf, sizeof(buf), "%.2fs", ns / 1e9);
+    }
+    return buf;
+}
+
+/// Formats a number of bytes using a sensible unit
+inline std::string format_bytes(std::size_t bytes)
+{
+    char buf[32];
+    if (bytes < 1024) {
+        std::snprintf(buf, sizeof(buf), "%zuB", bytes);
+    } else if (bytes < 1024 * 1024) {
+        std::snprintf(buf, sizeof(buf), "%.1fKiB", bytes / 1024.0);
+    } else {
+        std::snprintf(buf, sizeof(buf), "%.2fMiB", bytes / (1024.0 * 1024.0));
+    }
+    return buf;
+}
+
+/// The result of running one benchmark on one corpus
+struct result {
+    std::string group;       ///< What is being done, e.g. "u8 to u16"
+    std::string impl;        ///< Who is doing it, e.g. "boost"
+    std::string corpus;      ///< The input text
+    std::uint64_t corpus_hash = 0;
+    std::size_t input_bytes = 0;
+    std::size_t code_points = 0;
+    std::size_t iterations_per_run = 0;
+    stats ns_per_call;
+    std::vector<double> samples; ///< Nanoseconds per call, for each run
+    counter_values counters;
+    alloc_stats allocs;
+
+    /// Input bytes per nanosecond, which is the same thing as GB/s
+    double gb_per_sec() const
+    {
+        return ns_per_call.median > 0 ? input_bytes / ns_per_call.median : 0.0;
+    }
+
+    double code_points_per_ns() const
+    {
+        return ns_per_call.median > 0 ? code_points / ns_per_call.median : 0.0;
+    }
+
+    /// Hardware counter value per input byte
+    double per_byte(counter c) const
+    {
+        return input_bytes > 0 ? counters[c] / input_bytes : 0.0;
+    }
+
+    /// Instructions per cycle
+    double ipc() const
+    {
+        return counters[counter::cycles] > 0
+                ? counters[counter::instructions] / counters[counter::cycles]
+                : 0.0;
+    }
+};
+
+/// A collection of benchmarks, each of which is run against the current
+/// corpus. Functions are registered with add() and then run with run().
+class suite {
+public:
+    explicit suite(options opts)
+        : opts_(std::move(opts))
+    {}
+
+    const options& opts() const { return opts_; }
+
+    /// Sets the corpus for subsequently added benchmarks. The hash
+    /// identifies the exact input, so that results can be compared safely.
+    void set_corpus(std::string name, std::size_t code_points, std::uint64_t hash = 0)
+    {
+        corpus_ = std::move(name);
+        code_points_ = code_points;
+        corpus_hash_ = hash;
+    }
+
+    /// Registers fn, which processes input_bytes bytes of the current
+    /// corpus each time it is called
+    template <typename Fn>
+    void add(std::string group, std::string impl, std::size_t input_bytes, Fn fn)
+    {
+        entry e;
+        e.r.group = std::move(group);
+        e.r.impl = std::move(impl);
+        e.r.corpus = corpus_;
+        e.r.corpus_hash = corpus_hash_;
+        e.r.input_bytes = input_bytes;
+        e.r.code_points = code_points_;
+        e.run = [fn](const options& opts, perf_counters* pc) mutable {
+            return measure(fn, opts, pc);
+        };
+        entries_.push_back(std::move(e));
+    }
+
+    /// Runs everything which matches the filter, printing results as we go
+    std::vector<result> run(std::ostream& os = std::cout)
+    {
+        std::vector<result> results;
+        std::string last_heading;
+
+        std::unique_ptr<perf_counters> pc;
+        if (opts_.counters) {
+            pc.reset(new perf_counters);
+            if (!pc->available()) {
+                std::cerr << "Warning: hardware performance counters are not available "
+                             "(check /proc/sys/kernel/perf_event_paranoid)\n";
+                pc.reset();
+            }
+        }
+
+        for (entry& e : entries_) {
+            const std::string name = e.r.corpus + "/" + e.r.group + "/" + e.r.impl;
+            if (name.find(opts_.filter) == std::string::npos) {
+                continue;
+            }
+
+            const std::string heading = e.r.corpus + "/" + e.r.group;
+            if (heading != last_heading) {
+                print_heading(os, e.r, pc != nullptr, opts_.allocations);
+                last_heading = heading;
+            }
+
+            const measurement m = e.run(opts_, pc.get());
+            e.r.iterations_per_run = m.iterations_per_run;
+            e.r.ns_per_call = compute_stats(m.ns_per_call);
+            e.r.samples = m.ns_per_call;
+            e.r.counters = m.counters;
+            e.r.allocs = m.allocs;
+            print_result(os, e.r);
+            results.push_back(e.r);
+        }
+
+        return results;
+    }
+
+private:
+    struct entry {
+        result r;
+        std::function<measurement(const options&, perf_counters*)> run;
+    };
+
+    static void print_heading(std::ostream& os, const result& r, bool counters,
+                              bool allocations)
+    {
+        char buf[256];
+        std::snprintf(buf, sizeof(buf),
+                      "\n%s: %s (%zu bytes, %zu code points)\n"
+                      "  %-22s %12s %8s %10s %10s",
+                      r.corpus.c_str(), r.group.c_str(), r.input_bytes, r.code_points,
+                      "", "median", "+/- MAD", "GB/s", "cp/ns");
+        os << buf;
+        if (counters) {
+            std::snprintf(buf, sizeof(buf), " %9s %6s %10s %10s %10s",
+                          "cyc/B", "IPC", "brmiss/KB", "L1miss/KB", "LLCmiss/KB");
+            os << buf;
+        }
+        if (allocations) {
+            std::snprintf(buf, sizeof(buf), " %7s %10s %10s", "allocs", "allocated", "peak");
+            os << buf;
+        }
+        os << '\n';
+    }
+
+    // Prints a counter-derived value, or n/a if the counter wasn't available
+    static void print_counter(std::ostream& os, int width, const char* format,
+                              bool valid, double value)
+    {
+        char buf[32];
+        if (valid) {
+            std::snprintf(buf, sizeof(buf), format, width, value);
+        } else {
+            std::snprintf(buf, sizeof(buf), " %*s", width, "n/a");
+        }
+        os << buf;
+    }
+
+    static void print_result(std::ostream& os, const result& r)
+    {
+        const stats& s = r.ns_per_call;
+        char buf[256];
+        std::snprintf(buf, sizeof(buf), "  %-22s %12s %7.2f%% %10.3f %10.3f",
+                      r.impl.c_str(), format_time(s.median).c_str(),
+                      s.median > 0 ? 100.0 * s.mad / s.median : 0.0,
+                      r.gb_per_sec(), r.code_points_per_ns());
+        os << buf;
+
+        const counter_values& c = r.counters;
+        if (c.any()) {
+            print_counter(os, 9, " %*.3f", c.has(counter::cycles),
+                          r.per_byte(counter::cycles));
+            print_counter(os, 6, " %*.2f", c.has(counter::cycles) && c.has(counter::instructions),
+                          r.ipc());
+            print_counter(os, 10, " %*.3f", c.has(counter::branch_misses),
+                          1024 * r.per_byte(counter::branch_misses));
+            print_counter(os, 10, " %*.3f", c.has(counter::l1d_read_misses),
+                          1024 * r.per_byte(counter::l1d_read_misses));
+            print_counter(os, 10, " %*.3f", c.has(counter::llc_misses),
+                          1024 * r.per_byte(counter::llc_misses));
+        }
+
+        if (r.allocs.measured) {
+            std::snprintf(buf, sizeof(buf), " %7zu %10s %10s", r.allocs.allocations,
+                          format_bytes(r.allocs.bytes).c_str(),
+                          format_bytes(r.allocs.peak_bytes).c_str());
+            os << buf;
+        }
+        os << '\n' << std::flush;
+    }
+
+    options opts_;
+    std::string corpus_;
+    std::size_t code_points_ = 0;
+    std::uint64_t corpus_hash_ = 0;
+    std::vector<entry> entries_;
+};
+
+} // end namespace bench
+
+#endif // TCB_UTF_RANGES_BENCHMARK_HARNESS_HPP_INCLUDED
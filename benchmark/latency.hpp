@@ -0,0 +1,213 @@
+// Copyright (c) 2016 Tristan Brindle (tcbrindle at gmail dot com)
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef TCB_UTF_RANGES_BENCHMARK_LATENCY_HPP_INCLUDED
+#define TCB_UTF_RANGES_BENCHMARK_LATENCY_HPP_INCLUDED
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "corpus.hpp"
+#include "harness.hpp"
+
+// Per-call latency of conversions of short strings. The throughput
+// benchmarks convert a megabyte at a time, which hides the fixed cost of
+// each call; here every call is timed on its own, over a pool of strings
+// of varying lengths, and we report percentiles of the distribution.
+
+namespace bench {
+
+/// Cuts count strings of between min_bytes and max_bytes bytes out of the
+/// UTF-8 text, at code point boundaries
+inline std::vector<std::string> make_small_strings(const std::string& text,
+                                                   std::size_t min_bytes,
+                                                   std::size_t max_bytes,
+                                                   std::size_t count,
+                                                   std::uint64_t seed)
+{
+    const auto is_trail = [&text](std::size_t i) {
+        return i < text.size() && (static_cast<unsigned char>(text[i]) & 0xC0) == 0x80;
+    };
+
+    prng rng{seed};
+    std::vector<std::string> strings;
+    strings.reserve(count);
+
+    while (strings.size() < count && text.size() > max_bytes) {
+        std::size_t first = rng.below(static_cast<std::uint32_t>(text.size() - max_bytes));
+        while (is_trail(first)) {
+            ++first;
+        }
+        std::size_t last = first + rng.between(static_cast<std::uint32_t>(min_bytes),
+                                               static_cast<std::uint32_t>(max_bytes));
+        while (last > first && is_trail(last)) {
+            --last;
+        }
+        if (last - first >= min_bytes && last <= text.size()) {
+            strings.push_back(text.substr(first, last - first));
+        }
+    }
+
+    return strings;
+}
+
+/// Percentiles of the time per call, in nanoseconds
+struct latency_stats {
+    double p50 = 0.0;
+    double p99 = 0.0;
+    double p999 = 0.0;
+    double max = 0.0;
+    std::size_t calls = 0;
+};
+
+/// Returns the p'th percentile (0 <= p <= 1) of the sorted samples, using
+/// the nearest-rank method
+inline double percentile(const std::vector<double>& sorted, double p)
+{
+    if (sorted.empty()) {
+        return 0.0;
+    }
+    const auto rank = static_cast<std::size_t>(p * static_cast<double>(sorted.size()));
+    return sorted[std::min(rank, sorted.size() - 1)];
+}
+
+/// The time taken to read the clock twice, which is subtracted from each
+/// sample. It is the same order of magnitude as the calls being timed, so
+/// leaving it in would flatten the differences between them.
+inline double timer_overhead_ns()
+{
+    std::vector<double> samples;
+    samples.reserve(1000);
+    for (int i = 0; i < 1000; i++) {
+        const auto start = bench_clock::now();
+        const auto end = bench_clock::now();
+        samples.push_back(static_cast<double>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count()));
+    }
+    return median_of(std::move(samples));
+}
+
+/// Times each call of fn(input) for every input in the pool, over
+/// opts.runs passes, visiting the pool in a different order each time so
+/// that the branch predictor can't learn it. The result of each call is
+/// destroyed inside the timed region, as freeing memory is part of the cost.
+template <typename Input, typename Fn>
+latency_stats measure_latency(const std::vector<Input>& pool, Fn&& fn, const options& opts,
+                              double overhead_ns)
+{
+    std::vector<std::size_t> order(pool.size());
+    for (std::size_t i = 0; i < order.size(); i++) {
+        order[i] = i;
+    }
+
+    for (int run = 0; run < opts.warmup_runs; run++) {
+        for (const Input& in : pool) {
+            do_not_optimize(fn(in));
+        }
+    }
+
+    std::vector<double> samples;
+    samples.reserve(order.size() * static_cast<std::size_t>(opts.runs));
+    prng rng{static_cast<std::uint64_t>(pool.size())};
+
+    for (int run = 0; run < opts.runs; run++) {
+        // Fisher-Yates, with our own generator so the order is reproducible
+        for (std::size_t i = order.size(); i > 1; i--) {
+            std::swap(order[i - 1], order[rng.below(static_cast<std::uint32_t>(i))]);
+        }
+
+        for (std::size_t i : order) {
+            const auto start = bench_clock::now();
+            {
+                auto r = fn(pool[i]);
+                do_not_optimize(r);
+            }
+            const auto end = bench_clock::now();
+            const double ns = static_cast<double>(
+                    std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+            samples.push_back(std::max(ns - overhead_ns, 0.0));
+        }
+    }
+
+    std::sort(samples.begin(), samples.end());
+
+    latency_stats s;
+    s.calls = samples.size();
+    s.p50 = percentile(samples, 0.50);
+    s.p99 = percentile(samples, 0.99);
+    s.p999 = percentile(samples, 0.999);
+    s.max = samples.empty() ? 0.0 : samples.back();
+    return s;
+}
+
+/// A set of latency benchmarks, printed as they are run. Benchmarks are
+/// grouped under a heading naming the pool of inputs and the conversion.
+class latency_suite {
+public:
+    explicit latency_suite(const options& opts, std::ostream& os = std::cout)
+        : opts_(opts),
+          os_(os),
+          overhead_ns_(timer_overhead_ns())
+    {}
+
+    template <typename Input, typename Fn>
+    void run(const std::string& pool_name, const std::string& group, const char* impl,
+             const std::vector<Input>& pool, Fn&& fn)
+    {
+        const std::string name = pool_name + "/" + group + "/" + impl;
+        if (name.find(opts_.filter) == std::string::npos || pool.empty()) {
+            return;
+        }
+
+        const std::string heading = pool_name + "/" + group;
+        if (heading != last_heading_) {
+            print_heading(pool_name, group, pool);
+            last_heading_ = heading;
+        }
+
+        const latency_stats s = measure_latency(pool, fn, opts_, overhead_ns_);
+
+        char buf[256];
+        std::snprintf(buf, sizeof(buf), "  %-22s %10s %10s %10s %10s\n", impl,
+                      format_time(s.p50).c_str(), format_time(s.p99).c_str(),
+                      format_time(s.p999).c_str(), format_time(s.max).c_str());
+        os_ << buf << std::flush;
+    }
+
+private:
+    template <typename Input>
+    void print_heading(const std::string& pool_name, const std::string& group,
+                       const std::vector<Input>& pool)
+    {
+        std::size_t total = 0;
+        for (const Input& in : pool) {
+            total += in.size() * sizeof(in[0]);
+        }
+
+        char buf[256];
+        std::snprintf(buf, sizeof(buf),
+                      "\n%s: %s latency (%zu strings, mean %.1f bytes, timer overhead %.1fns)\n"
+                      "  %-22s %10s %10s %10s %10s\n",
+                      pool_name.c_str(), group.c_str(), pool.size(),
+                      static_cast<double>(total) / pool.size(), overhead_ns_,
+                      "", "p50", "p99", "p99.9", "max");
+        os_ << buf;
+    }
+
+    const options& opts_;
+    std::ostream& os_;
+    double overhead_ns_;
+    std::string last_heading_;
+};
+
+} // end namespace bench
+
+#endif // TCB_UTF_RANGES_BENCHMARK_LATENCY_HPP_INCLUDED
@@ -0,0 +1,184 @@
+// Copyright (c) 2016 Tristan Brindle (tcbrindle at gmail dot com)
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef TCB_UTF_RANGES_BENCHMARK_PERF_COUNTERS_HPP_INCLUDED
+#define TCB_UTF_RANGES_BENCHMARK_PERF_COUNTERS_HPP_INCLUDED
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace bench {
+
+/// The hardware events we count
+enum class counter {
+    cycles,
+    instructions,
+    branch_misses,
+    l1d_read_misses,
+    llc_misses
+};
+
+constexpr std::size_t num_counters = 5;
+
+inline const char* counter_name(counter c)
+{
+    switch (c) {
+    case counter::cycles: return "cycles";
+    case counter::instructions: return "instructions";
+    case counter::branch_misses: return "branch-misses";
+    case counter::l1d_read_misses: return "L1d-read-misses";
+    case counter::llc_misses: return "LLC-misses";
+    }
+    return "unknown";
+}
+
+/// Counter values (typically per call of the benchmarked function). Any
+/// counter which couldn't be read is marked as invalid.
+struct counter_values {
+    std::array<double, num_counters> value{};
+    std::array<bool, num_counters> valid{};
+
+    bool has(counter c) const { return valid[static_cast<std::size_t>(c)]; }
+
+    double operator[](counter c) const { return value[static_cast<std::size_t>(c)]; }
+
+    bool any() const
+    {
+        for (bool v : valid) {
+            if (v) {
+                return true;
+            }
+        }
+        return false;
+    }
+};
+
+/// Hardware performance counters for the calling thread, using Linux's
+/// perf_event_open(). Each counter is opened separately, so that we still
+/// get whatever the machine supports if some of them aren't available
+/// (in a VM, say, or with a restrictive perf_event_paranoid setting).
+/// On other platforms, or if nothing can be opened, available() returns
+/// false and stop() returns no valid values.
+class perf_counters {
+public:
+    perf_counters()
+    {
+        fds_.fill(-1);
+#if defined(__linux__)
+        open(counter::cycles, PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+        open(counter::instructions, PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+        open(counter::branch_misses, PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES);
+        open(counter::l1d_read_misses, PERF_TYPE_HW_CACHE,
+             PERF_COUNT_HW_CACHE_L1D |
+             (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+             (PERF_COUNT_HW_CACHE_RESULT_MISS << 16));
+        open(counter::llc_misses, PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES);
+#endif
+    }
+
+    perf_counters(const perf_counters&) = delete;
+    perf_counters& operator=(const perf_counters&) = delete;
+
+    ~perf_counters()
+    {
+#if defined(__linux__)
+        for (int fd : fds_) {
+            if (fd >= 0) {
+                ::close(fd);
+            }
+        }
+#endif
+    }
+
+    bool available() const
+    {
+        for (int fd : fds_) {
+            if (fd >= 0) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /// Resets and starts all the counters
+    void start()
+    {
+#if defined(__linux__)
+        for (int fd : fds_) {
+            if (fd >= 0) {
+                ::ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+                ::ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+            }
+        }
+#endif
+    }
+
+    /// Stops the counters, and returns their values divided by divisor.
+    /// If the kernel had to multiplex the counters, the values are scaled
+    /// up to estimate the count over the whole period.
+    counter_values stop(double divisor = 1.0)
+    {
+        counter_values result;
+#if defined(__linux__)
+        for (int fd : fds_) {
+            if (fd >= 0) {
+                ::ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+            }
+        }
+
+        for (std::size_t i = 0; i < num_counters; i++) {
+            if (fds_[i] < 0) {
+                continue;
+            }
+
+            // value, time enabled, time running
+            std::uint64_t data[3] = {};
+            if (::read(fds_[i], data, sizeof(data)) != sizeof(data) || data[2] == 0) {
+                continue;
+            }
+
+            const double scale = static_cast<double>(data[1]) / static_cast<double>(data[2]);
+            result.value[i] = static_cast<double>(data[0]) * scale / divisor;
+            result.valid[i] = true;
+        }
+#else
+        (void) divisor;
+#endif
+        return result;
+    }
+
+private:
+#if defined(__linux__)
+    void open(counter c, std::uint32_t type, std::uint64_t config)
+    {
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = type;
+        attr.config = config;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+        const long fd = ::syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+        fds_[static_cast<std::size_t>(c)] = static_cast<int>(fd);
+    }
+#endif
+
+    std::array<int, num_counters> fds_;
+};
+
+} // end namespace bench
+
+#endif // TCB_UTF_RANGES_BENCHMARK_PERF_COUNTERS_HPP_INCLUDED
@@ -0,0 +1,216 @@
+// Copyright (c) 2016 Tristan Brindle (tcbrindle at gmail dot com)
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef TCB_UTF_RANGES_BENCHMARK_PIPELINES_HPP_INCLUDED
+#define TCB_UTF_RANGES_BENCHMARK_PIPELINES_HPP_INCLUDED
+
+#include <array>
+#include <cstddef>
+#include <istream>
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include <type_traits>
+
+#include <range/v3/algorithm/copy.hpp>
+
+#include <tcb/utf_ranges/fused.hpp>
+#include <tcb/utf_ranges/istreambuf_range.hpp>
+#include <tcb/utf_ranges/ostreambuf_iterator.hpp>
+#include <tcb/utf_ranges/view.hpp>
+
+#include "harness.hpp"
+
+// Benchmarks for the views other than the encoding conversions, and for the
+// file-to-file pipeline from the README
+
+namespace bench {
+
+/// A streambuf which reads from a string in memory, without copying it
+template <typename CharT>
+class source_buf : public std::basic_streambuf<CharT> {
+public:
+    explicit source_buf(const std::basic_string<CharT>& str)
+    {
+        CharT* first = const_cast<CharT*>(str.data());
+        this->setg(first, first, first + str.size());
+    }
+};
+
+/// A streambuf which throws away everything written to it, apart from
+/// counting it. It has a buffer, like a file would, so writes don't go
+/// through a virtual call for every character.
+template <typename CharT>
+class sink_buf : public std::basic_streambuf<CharT> {
+    using traits_type = std::char_traits<CharT>;
+    using int_type = typename traits_type::int_type;
+
+public:
+    sink_buf() { reset(); }
+
+    std::size_t size() const
+    {
+        return count_ + static_cast<std::size_t>(this->pptr() - this->pbase());
+    }
+
+protected:
+    int_type overflow(int_type c) override
+    {
+        count_ += static_cast<std::size_t>(this->pptr() - this->pbase());
+        reset();
+        if (!traits_type::eq_int_type(c, traits_type::eof())) {
+            this->sputc(traits_type::to_char_type(c));
+        }
+        return traits_type::not_eof(c);
+    }
+
+private:
+    void reset() { this->setp(buf_.data(), buf_.data() + buf_.size()); }
+
+    std::array<CharT, 4096> buf_;
+    std::size_t count_ = 0;
+};
+
+// Bytes (unsigned char) are written to a char stream, as they would be to a
+// file
+template <typename Range>
+using sink_char_t = std::conditional_t<sizeof(::ranges::v3::range_value_t<Range>) == 1,
+                                       char, ::ranges::v3::range_value_t<Range>>;
+
+/// Copies range to a sink with ostreambuf_iterator, returning the number of
+/// elements written. Every view is consumed in the same way, so the times
+/// for different views can be compared directly.
+template <typename Range>
+std::size_t drain(Range&& range)
+{
+    using char_type = sink_char_t<Range>;
+
+    sink_buf<char_type> buf;
+    std::basic_ostream<char_type> os(&buf);
+    ::ranges::v3::copy(range, tcb::utf_ranges::ostreambuf_iterator<char_type>{os});
+    return buf.size();
+}
+
+/// As drain(), but with fused_copy()
+template <typename Range>
+std::size_t fused_drain(Range&& range)
+{
+    using char_type = sink_char_t<Range>;
+
+    sink_buf<char_type> buf;
+    std::basic_ostream<char_type> os(&buf);
+    tcb::utf_ranges::fused_copy(range, tcb::utf_ranges::ostreambuf_iterator<char_type>{os});
+    return buf.size();
+}
+
+/// Registers benchmarks for each of the shipped views and I/O adaptors.
+/// The strings must outlive the suite.
+inline void add_view_benchmarks(suite& s, const std::string& u8, const std::string& u8_bom,
+                                const std::u16string& u16, const std::u16string& u16_bom)
+{
+    namespace utf = ::tcb::utf_ranges;
+    namespace view = ::tcb::utf_ranges::view;
+    using boost::endian::order;
+
+    const std::size_t u8_bytes = u8.size();
+    const std::size_t u16_bytes = u16.size() * sizeof(char16_t);
+
+    // The baseline: reading the input, with no view in between
+    s.add("views u8", "copy", u8_bytes, [&u8] { return drain(u8); });
+    s.add("views u16", "copy", u16_bytes, [&u16] { return drain(u16); });
+
+    s.add("views u8", "consume_bom forward", u8_bytes + 3,
+          [&u8_bom] { return drain(view::consume_bom(u8_bom)); });
+    s.add("views u8", "consume_bom input", u8_bytes + 3, [&u8_bom] {
+        source_buf<char> in_buf{u8_bom};
+        std::istream in{&in_buf};
+        return drain(utf::istreambuf(in) | view::consume_bom);
+    });
+    s.add("views u16", "consume_bom forward", u16_bytes + 2,
+          [&u16_bom] { return drain(view::consume_bom(u16_bom)); });
+    s.add("views u16", "consume_bom callback", u16_bytes + 2, [&u16_bom] {
+        return view::consume_bom(u16_bom, [](auto&& r) { return drain(r); });
+    });
+
+    // add_bom tests the count of remaining prefix code units for every
+    // element it yields; fused_drain() takes the prefix and base() as two
+    // separate phases, with no such test. Comparing the two rows with
+    // "copy" shows what that test costs.
+    s.add("views u8", "add_bom", u8_bytes, [&u8] { return drain(view::add_bom(u8)); });
+    s.add("views u8", "add_bom fused", u8_bytes,
+          [&u8] { return fused_drain(view::add_bom(u8)); });
+    s.add("views u16", "add_bom", u16_bytes, [&u16] { return drain(view::add_bom(u16)); });
+    s.add("views u16", "add_bom fused", u16_bytes,
+          [&u16] { return fused_drain(view::add_bom(u16)); });
+
+    s.add("views u16", "endian_convert", u16_bytes, [&u16] {
+        return drain(view::endian_convert<order::big>(u16, order::little));
+    });
+    s.add("views u16", "endian_convert static", u16_bytes, [&u16] {
+        return drain(view::endian_convert<order::little, order::big>(u16));
+    });
+
+    s.add("views u8", "bytes", u8_bytes, [&u8] { return drain(view::bytes(u8)); });
+    s.add("views u16", "bytes", u16_bytes, [&u16] { return drain(view::bytes(u16)); });
+
+    s.add("views u8", "line_end_transform lf", u8_bytes,
+          [&u8] { return drain(view::line_end_transform(u8)); });
+    s.add("views u8", "line_end_transform crlf", u8_bytes,
+          [&u8] { return drain(view::line_end_transform(u8, utf::line_end::crlf)); });
+    s.add("views u16", "line_end_transform lf", u16_bytes,
+          [&u16] { return drain(view::line_end_transform(u16)); });
+
+    s.add("views u8", "istreambuf_range", u8_bytes, [&u8] {
+        source_buf<char> in_buf{u8};
+        std::istream in{&in_buf};
+        return drain(utf::istreambuf(in));
+    });
+}
+
+/// Registers the README's file pipeline (UTF-8 in, UTF-16BE with a BOM out),
+/// built up one stage at a time. The difference between each row and the
+/// one before it is the cost of the stage that was added.
+inline void add_pipeline_benchmarks(suite& s, const std::string& u8_bom)
+{
+    namespace utf = ::tcb::utf_ranges;
+    namespace view = ::tcb::utf_ranges::view;
+    using boost::endian::order;
+
+    const std::size_t bytes = u8_bom.size();
+
+    const auto stage = [&s, &u8_bom, bytes](const char* name, auto make_view) {
+        s.add("pipeline", name, bytes, [&u8_bom, make_view] {
+            source_buf<char> in_buf{u8_bom};
+            std::istream in{&in_buf};
+            return drain(make_view(utf::istreambuf(in)));
+        });
+    };
+
+    stage("1 istreambuf", [](auto&& r) { return r; });
+    stage("2 +consume_bom", [](auto&& r) { return r | view::consume_bom; });
+    stage("3 +utf16", [](auto&& r) { return r | view::consume_bom | view::utf16; });
+    stage("4 +add_bom", [](auto&& r) {
+        return r | view::consume_bom | view::utf16 | view::add_bom;
+    });
+    stage("5 +endian_convert", [](auto&& r) {
+        return r | view::consume_bom | view::utf16 | view::add_bom
+                 | view::endian_convert<order::big>;
+    });
+    stage("6 +bytes", [](auto&& r) {
+        return r | view::consume_bom | view::utf16 | view::add_bom
+                 | view::endian_convert<order::big> | view::bytes;
+    });
+
+    s.add("pipeline", "6 fused", bytes, [&u8_bom] {
+        source_buf<char> in_buf{u8_bom};
+        std::istream in{&in_buf};
+        return fused_drain(utf::istreambuf(in) | view::consume_bom | view::utf16
+                           | view::add_bom | view::endian_convert<order::big>
+                           | view::bytes);
+    });
+}
+
+} // end namespace bench
+
+#endif // TCB_UTF_RANGES_BENCHMARK_PIPELINES_HPP_INCLUDED
@@ -0,0 +1,286 @@
+// Copyright (c) 2016 Tristan Brindle (tcbrindle at gmail dot com)
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef TCB_UTF_RANGES_BENCHMARK_REPORT_HPP_INCLUDED
+#define TCB_UTF_RANGES_BENCHMARK_REPORT_HPP_INCLUDED
+
+#include <cstdint>
+#include <cstdio>
+#include <ctime>
+#include <fstream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/utsname.h>
+#include <unistd.h>
+#endif
+
+#include "harness.hpp"
+
+// Machine-readable benchmark results, for benchmark_compare
+
+#ifndef BENCHMARK_CXX_FLAGS
+#define BENCHMARK_CXX_FLAGS "unknown"
+#endif
+
+#ifndef BENCHMARK_BUILD_TYPE
+#define BENCHMARK_BUILD_TYPE "unknown"
+#endif
+
+namespace bench {
+
+/// 64-bit FNV-1a hash, used to identify corpora
+inline std::uint64_t fnv1a(const void* data, std::size_t size)
+{
+    const auto* p = static_cast<const unsigned char*>(data);
+    std::uint64_t h = 0xCBF29CE484222325ull;
+    for (std::size_t i = 0; i < size; i++) {
+        h = (h ^ p[i]) * 0x100000001B3ull;
+    }
+    return h;
+}
+
+inline std::string to_hex(std::uint64_t x)
+{
+    char buf[17];
+    std::snprintf(buf, sizeof(buf), "%016llx", static_cast<unsigned long long>(x));
+    return buf;
+}
+
+/// Where, and how, the results were produced
+struct machine_info {
+    std::string date;
+    std::string host;
+    std::string os;
+    std::string cpu;
+    long num_cpus = 0;
+    std::string compiler;
+    std::string flags = BENCHMARK_CXX_FLAGS;
+    std::string build_type = BENCHMARK_BUILD_TYPE;
+};
+
+inline machine_info get_machine_info()
+{
+    machine_info m;
+
+    char date[32];
+    const std::time_t now = std::time(nullptr);
+    std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&now));
+    m.date = date;
+
+#if defined(__unix__) || defined(__APPLE__)
+    utsname u;
+    if (uname(&u) == 0) {
+        m.host = u.nodename;
+        m.os = std::string(u.sysname) + " " + u.release + " " + u.machine;
+    }
+    m.num_cpus = sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+
+    std::ifstream cpuinfo("/proc/cpuinfo");
+    std::string line;
+    while (std::getline(cpuinfo, line)) {
+        if (line.compare(0, 10, "model name") == 0) {
+            const auto colon = line.find(':');
+            if (colon != std::string::npos) {
+                m.cpu = line.substr(line.find_first_not_of(' ', colon + 1));
+            }
+            break;
+        }
+    }
+
+#if defined(__clang__)
+    m.compiler = "clang " __clang_version__;
+#elif defined(__GNUC__)
+    m.compiler = "gcc " __VERSION__;
+#elif defined(_MSC_VER)
+    m.compiler = "msvc " + std::to_string(_MSC_FULL_VER);
+#else
+    m.compiler = "unknown";
+#endif
+
+    return m;
+}
+
+namespace detail {
+
+inline std::string json_string(const std::string& s)
+{
+    std::string out = "\"";
+    for (char c : s) {
+        switch (c) {
+        case '"': out += "\\\""; break;
+        case '\\': out += "\\\\"; break;
+        case '\n': out += "\\n"; break;
+        case '\t': out += "\\t"; break;
+        default:
+            if (static_cast<unsigned char>(c) < 0x20) {
+                char buf[8];
+                std::snprintf(buf, sizeof(buf), "\\u%04x", c);
+                out += buf;
+            } else {
+                out += c;
+            }
+        }
+    }
+    return out + "\"";
+}
+
+inline std::string json_number(double d)
+{
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "%.6g", d);
+    return buf;
+}
+
+inline std::string csv_string(const std::string& s)
+{
+    if (s.find_first_of(",\"\n") == std::string::npos) {
+        return s;
+    }
+    std::string out = "\"";
+    for (char c : s) {
+        if (c == '"') {
+            out += '"';
+        }
+        out += c;
+    }
+    return out + "\"";
+}
+
+} // end namespace detail
+
+/// Writes the results, with the machine information and the options they
+/// were run with, as JSON. The raw samples are included so that
+/// benchmark_compare can test whether differences are significant.
+inline void write_json(std::ostream& os, const machine_info& m, const options& opts,
+                       const std::vector<result>& results)
+{
+    using detail::json_number;
+    using detail::json_string;
+
+    os << "{\n"
+       << "  \"context\": {\n"
+       << "    \"date\": " << json_string(m.date) << ",\n"
+       << "    \"host\": " << json_string(m.host) << ",\n"
+       << "    \"os\": " << json_string(m.os) << ",\n"
+       << "    \"cpu\": " << json_string(m.cpu) << ",\n"
+       << "    \"num_cpus\": " << m.num_cpus << ",\n"
+       << "    \"compiler\": " << json_string(m.compiler) << ",\n"
+       << "    \"flags\": " << json_string(m.flags) << ",\n"
+       << "    \"build_type\": " << json_string(m.build_type) << ",\n"
+       << "    \"runs\": " << opts.runs << ",\n"
+       << "    \"warmup_runs\": " << opts.warmup_runs << ",\n"
+       << "    \"min_run_time_ns\": " << opts.min_run_time.count() << ",\n"
+       << "    \"cpu_pinned\": " << opts.cpu << "\n"
+       << "  },\n"
+       << "  \"results\": [";
+
+    for (std::size_t i = 0; i < results.size(); i++) {
+        const result& r = results[i];
+        os << (i == 0 ? "\n" : ",\n")
+           << "    {\"corpus\": " << json_string(r.corpus)
+           << ", \"corpus_hash\": " << json_string(to_hex(r.corpus_hash))
+           << ", \"group\": " << json_string(r.group)
+           << ", \"impl\": " << json_string(r.impl)
+           << ", \"input_bytes\": " << r.input_bytes
+           << ", \"code_points\": " << r.code_points
+           << ", \"iterations_per_run\": " << r.iterations_per_run
+           << ", \"median_ns\": " << json_number(r.ns_per_call.median)
+           << ", \"mad_ns\": " << json_number(r.ns_per_call.mad)
+           << ", \"min_ns\": " << json_number(r.ns_per_call.min)
+           << ", \"max_ns\": " << json_number(r.ns_per_call.max)
+           << ", \"gb_per_sec\": " << json_number(r.gb_per_sec())
+           << ", \"code_points_per_ns\": " << json_number(r.code_points_per_ns())
+           << ", \"samples_ns\": [";
+        for (std::size_t j = 0; j < r.samples.size(); j++) {
+            os << (j == 0 ? "" : ", ") << json_number(r.samples[j]);
+        }
+        os << "]";
+
+        if (r.counters.any()) {
+            os << ", \"counters\": {";
+            bool first = true;
+            for (std::size_t c = 0; c < num_counters; c++) {
+                if (r.counters.valid[c]) {
+                    os << (first ? "" : ", ")
+                       << json_string(counter_name(static_cast<counter>(c))) << ": "
+                       << json_number(r.counters.value[c]);
+                    first = false;
+                }
+            }
+            os << "}";
+        }
+
+        if (r.allocs.measured) {
+            os << ", \"allocations\": {\"count\": " << r.allocs.allocations
+               << ", \"bytes\": " << r.allocs.bytes
+               << ", \"peak_bytes\": " << r.allocs.peak_bytes << "}";
+        }
+        os << "}";
+    }
+
+    os << "\n  ]\n}\n";
+}
+
+/// Writes the results as CSV, one row per benchmark, preceded by comment
+/// lines giving the machine information
+inline void write_csv(std::ostream& os, const machine_info& m, const options& opts,
+                      const std::vector<result>& results)
+{
+    using detail::csv_string;
+
+    os << "# date: " << m.date << "\n"
+       << "# host: " << m.host << "\n"
+       << "# os: " << m.os << "\n"
+       << "# cpu: " << m.cpu << "\n"
+       << "# num_cpus: " << m.num_cpus << "\n"
+       << "# compiler: " << m.compiler << "\n"
+       << "# flags: " << m.flags << "\n"
+       << "# build_type: " << m.build_type << "\n"
+       << "# runs: " << opts.runs << ", warmup_runs: " << opts.warmup_runs
+       << ", min_run_time_ns: " << opts.min_run_time.count() << "\n";
+
+    os << "corpus,corpus_hash,group,impl,input_bytes,code_points,iterations_per_run,"
+          "median_ns,mad_ns,min_ns,max_ns,gb_per_sec,code_points_per_ns";
+    for (std::size_t c = 0; c < num_counters; c++) {
+        os << "," << counter_name(static_cast<counter>(c));
+    }
+    os << ",allocations,alloc_bytes,peak_alloc_bytes\n";
+
+    for (const result& r : results) {
+        os << csv_string(r.corpus) << ","
+           << to_hex(r.corpus_hash) << ","
+           << csv_string(r.group) << ","
+           << csv_string(r.impl) << ","
+           << r.input_bytes << ","
+           << r.code_points << ","
+           << r.iterations_per_run << ","
+           << detail::json_number(r.ns_per_call.median) << ","
+           << detail::json_number(r.ns_per_call.mad) << ","
+           << detail::json_number(r.ns_per_call.min) << ","
+           << detail::json_number(r.ns_per_call.max) << ","
+           << detail::json_number(r.gb_per_sec()) << ","
+           << detail::json_number(r.code_points_per_ns());
+        for (std::size_t c = 0; c < num_counters; c++) {
+            os << ",";
+            if (r.counters.valid[c]) {
+                os << detail::json_number(r.counters.value[c]);
+            }
+        }
+        if (r.allocs.measured) {
+            os << "," << r.allocs.allocations << "," << r.allocs.bytes << ","
+               << r.allocs.peak_bytes;
+        } else {
+            os << ",,,";
+        }
+        os << "\n";
+    }
+}
+
+} // end namespace bench
+
+#endif // TCB_UTF_RANGES_BENCHMARK_REPORT_HPP_INCLUDED
@@ -0,0 +1,353 @@
+// Copyright (c) 2016 Tristan Brindle (tcbrindle at gmail dot com)
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef TCB_UTF_RANGES_BENCHMARK_SCALING_HPP_INCLUDED
+#define TCB_UTF_RANGES_BENCHMARK_SCALING_HPP_INCLUDED
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "harness.hpp"
+
+// Multicore scaling: the same conversion run on 1 to N threads, either with
+// each thread working through its own buffer (a pool of workers serving
+// independent requests) or with one large buffer split between the threads
+// (parallelising a single job). Each is compared with memcpy() of the same
+// data on the same number of threads, which is as fast as the machine can
+// move those bytes, so we can see where a conversion stops being limited by
+// computation and starts being limited by memory bandwidth.
+
+namespace bench {
+
+/// A fixed set of threads which repeatedly run a job together. The calling
+/// thread takes part as thread 0, so a team of one runs the job directly.
+/// The helper threads spin (yielding) between jobs, so starting one costs
+/// very little, but nothing else should run while a team exists; in
+/// particular, don't keep more than one team at a time.
+class thread_team {
+public:
+    /// If first_cpu >= 0, thread i is pinned to CPU first_cpu + i
+    explicit thread_team(std::size_t size, int first_cpu = -1)
+        : size_(size)
+    {
+        for (std::size_t i = 1; i < size; i++) {
+            threads_.emplace_back([this, i, first_cpu] {
+                if (first_cpu >= 0) {
+                    pin_to_cpu(first_cpu + static_cast<int>(i));
+                }
+                worker(i);
+            });
+        }
+    }
+
+    thread_team(const thread_team&) = delete;
+    thread_team& operator=(const thread_team&) = delete;
+
+    ~thread_team()
+    {
+        stop_ = true;
+        for (auto& t : threads_) {
+            t.join();
+        }
+    }
+
+    std::size_t size() const { return size_; }
+
+    /// Calls job(i) on each thread i of the team, and waits for them all
+    void run(const std::function<void(std::size_t)>& job)
+    {
+        job_ = &job;
+        remaining_ = size_ - 1;
+        ++generation_;
+        job(0);
+        while (remaining_ != 0) {
+            std::this_thread::yield();
+        }
+    }
+
+private:
+    void worker(std::size_t index)
+    {
+        std::size_t seen = 0;
+        for (;;) {
+            while (generation_ == seen && !stop_) {
+                std::this_thread::yield();
+            }
+            if (stop_) {
+                return;
+            }
+            seen = generation_;
+            (*job_)(index);
+            --remaining_;
+        }
+    }
+
+    std::size_t size_;
+    std::vector<std::thread> threads_;
+    const std::function<void(std::size_t)>* job_ = nullptr;
+    std::atomic<std::size_t> generation_{0};
+    std::atomic<std::size_t> remaining_{0};
+    std::atomic<bool> stop_{false};
+};
+
+/// Thread counts to try: powers of two up to max_threads, and max_threads
+inline std::vector<std::size_t> thread_counts(std::size_t max_threads)
+{
+    std::vector<std::size_t> counts;
+    for (std::size_t n = 1; n < max_threads; n *= 2) {
+        counts.push_back(n);
+    }
+    counts.push_back(max_threads);
+    return counts;
+}
+
+/// Splits a buffer of code units into parts contiguous pieces, without
+/// splitting any code point, returning the parts + 1 boundaries
+template <typename CharT>
+std::vector<std::size_t> split_points(const std::basic_string<CharT>& str, std::size_t parts)
+{
+    // UTF-8 continuation bytes, and UTF-16 trail surrogates
+    const auto is_trail = [&str](std::size_t i) {
+        const auto c = static_cast<std::uint32_t>(str[i]);
+        return sizeof(CharT) == 1 ? (c & 0xC0) == 0x80
+                                  : sizeof(CharT) == 2 && c >= 0xDC00 && c <= 0xDFFF;
+    };
+
+    std::vector<std::size_t> points{0};
+    for (std::size_t i = 1; i < parts; i++) {
+        std::size_t p = std::max(str.size() * i / parts, points.back());
+        while (p < str.size() && is_trail(p)) {
+            ++p;
+        }
+        points.push_back(p);
+    }
+    points.push_back(str.size());
+    return points;
+}
+
+/// One row of a scaling table
+struct scaling_result {
+    std::string impl;
+    std::size_t threads = 0;
+    /// Input bytes processed per nanosecond, by all threads together
+    double gb_per_sec = 0.0;
+    /// Bytes read and written per nanosecond, by all threads together
+    double traffic_gb_per_sec = 0.0;
+};
+
+/// Runs and prints the scaling benchmarks for one conversion. Each
+/// implementation is registered with add(), and then run() tries each of
+/// them, and memcpy(), at each thread count.
+template <typename In, typename Out>
+class scaling_benchmark {
+public:
+    using conversion = Out (*)(const In&);
+
+    /// independent is converted in full by every thread; split is shared
+    /// between them
+    scaling_benchmark(std::string name, const In& independent, const In& split)
+        : name_(std::move(name)),
+          independent_(independent),
+          split_(split)
+    {}
+
+    void add(const char* impl, conversion fn) { impls_.push_back({impl, fn}); }
+
+    void run(const options& opts, std::size_t max_threads, std::ostream& os = std::cout)
+    {
+        if (!matches(opts, "independent") && !matches(opts, "split")) {
+            return;
+        }
+
+        const std::vector<std::size_t> counts = thread_counts(max_threads);
+        if (matches(opts, "independent")) {
+            run_independent(opts, counts, os);
+        }
+        if (matches(opts, "split")) {
+            run_split(opts, counts, os);
+        }
+    }
+
+private:
+    using char_type = typename In::value_type;
+    using out_char_type = typename Out::value_type;
+    // One row per thread count for memcpy(), then for each implementation
+    using result_table = std::vector<std::vector<scaling_result>>;
+
+    struct impl {
+        const char* name;
+        conversion fn;
+    };
+
+    bool matches(const options& opts, const char* scenario) const
+    {
+        return (name_ + "/" + scenario).find(opts.filter) != std::string::npos;
+    }
+
+    // Only one team exists at a time: its helpers spin between jobs, so an
+    // idle team would compete with the one being measured (and, with
+    // --cpu, be pinned to the same cores).
+    void run_independent(const options& opts, const std::vector<std::size_t>& counts,
+                         std::ostream& os)
+    {
+        const std::size_t bytes = independent_.size() * sizeof(char_type);
+        print_heading(os, "independent buffers", bytes, "per thread");
+
+        // Each thread gets its own copy of the input, and its own output
+        std::vector<In> inputs(counts.back(), independent_);
+        std::vector<In> copies(inputs.size(), independent_);
+
+        std::vector<std::size_t> out_bytes;
+        for (const impl& im : impls_) {
+            out_bytes.push_back(im.fn(independent_).size() * sizeof(out_char_type));
+        }
+
+        result_table table(impls_.size() + 1);
+        for (std::size_t n : counts) {
+            thread_team team{n, opts.cpu};
+
+            const double copy_ns = time_job(team, opts, [&](std::size_t i) {
+                std::memcpy(&copies[i][0], inputs[i].data(), bytes);
+                do_not_optimize(copies[i][0]);
+            });
+            table[0].push_back(make_result("memcpy", n, copy_ns, bytes * n, 2 * bytes * n));
+
+            for (std::size_t k = 0; k < impls_.size(); k++) {
+                const impl& im = impls_[k];
+                const double ns = time_job(team, opts, [&](std::size_t i) {
+                    do_not_optimize(im.fn(inputs[i]));
+                });
+                table[k + 1].push_back(make_result(im.name, n, ns, bytes * n,
+                                                   (bytes + out_bytes[k]) * n));
+            }
+        }
+        print_table(os, table);
+    }
+
+    void run_split(const options& opts, const std::vector<std::size_t>& counts,
+                   std::ostream& os)
+    {
+        const std::size_t bytes = split_.size() * sizeof(char_type);
+        print_heading(os, "one buffer split between threads", bytes, "in total");
+
+        In copy = split_;
+
+        result_table table(impls_.size() + 1);
+        for (std::size_t n : counts) {
+            thread_team team{n, opts.cpu};
+            const std::vector<std::size_t> points = split_points(split_, n);
+
+            const double copy_ns = time_job(team, opts, [&](std::size_t i) {
+                std::memcpy(&copy[points[i]], split_.data() + points[i],
+                            (points[i + 1] - points[i]) * sizeof(char_type));
+                do_not_optimize(copy[points[i]]);
+            });
+            table[0].push_back(make_result("memcpy", n, copy_ns, bytes, 2 * bytes));
+
+            // Each thread converts its part into a separate string; joining
+            // them up again is left out
+            std::vector<In> parts;
+            for (std::size_t i = 0; i < n; i++) {
+                parts.push_back(split_.substr(points[i], points[i + 1] - points[i]));
+            }
+
+            for (std::size_t k = 0; k < impls_.size(); k++) {
+                const impl& im = impls_[k];
+                std::size_t out_bytes = 0;
+                for (const In& part : parts) {
+                    out_bytes += im.fn(part).size() * sizeof(out_char_type);
+                }
+
+                const double ns = time_job(team, opts, [&](std::size_t i) {
+                    do_not_optimize(im.fn(parts[i]));
+                });
+                table[k + 1].push_back(make_result(im.name, n, ns, bytes, bytes + out_bytes));
+            }
+        }
+        print_table(os, table);
+    }
+
+    // Median time for the whole team to run job once, in nanoseconds
+    template <typename Job>
+    static double time_job(thread_team& team, const options& opts, Job job)
+    {
+        const std::function<void(std::size_t)> fn = job;
+        const measurement m = measure([&team, &fn] {
+            team.run(fn);
+            return 0;
+        }, opts);
+        return median_of(m.ns_per_call);
+    }
+
+    static scaling_result make_result(const char* impl, std::size_t threads, double ns,
+                                      std::size_t input_bytes, std::size_t traffic_bytes)
+    {
+        scaling_result r;
+        r.impl = impl;
+        r.threads = threads;
+        r.gb_per_sec = ns > 0 ? input_bytes / ns : 0.0;
+        r.traffic_gb_per_sec = ns > 0 ? traffic_bytes / ns : 0.0;
+        return r;
+    }
+
+    void print_heading(std::ostream& os, const char* scenario, std::size_t bytes,
+                       const char* per) const
+    {
+        char buf[256];
+        std::snprintf(buf, sizeof(buf),
+                      "\n%s, %s (%zu bytes %s)\n"
+                      "  %-22s %7s %10s %8s %10s %10s %10s\n",
+                      name_.c_str(), scenario, bytes, per,
+                      "", "threads", "GB/s", "speedup", "efficiency", "traffic", "% memcpy");
+        os << buf;
+    }
+
+    static void print_table(std::ostream& os, const result_table& table)
+    {
+        for (const auto& rows : table) {
+            print_rows(os, rows, table[0]);
+        }
+    }
+
+    // Speedup and efficiency are relative to the same implementation on one
+    // thread; the last column compares the bytes moved per second (read and
+    // written) with memcpy() on the same number of threads
+    static void print_rows(std::ostream& os, const std::vector<scaling_result>& rows,
+                           const std::vector<scaling_result>& baseline)
+    {
+        for (std::size_t i = 0; i < rows.size(); i++) {
+            const scaling_result& r = rows[i];
+            const double speedup = rows[0].gb_per_sec > 0
+                                   ? r.gb_per_sec / rows[0].gb_per_sec : 0.0;
+            const double of_memcpy = baseline[i].traffic_gb_per_sec > 0
+                                     ? r.traffic_gb_per_sec / baseline[i].traffic_gb_per_sec
+                                     : 0.0;
+            char buf[256];
+            std::snprintf(buf, sizeof(buf), "  %-22s %7zu %10.3f %7.2fx %9.1f%% %10.3f %9.1f%%\n",
+                          r.impl.c_str(), r.threads, r.gb_per_sec, speedup,
+                          100.0 * speedup / r.threads, r.traffic_gb_per_sec,
+                          100.0 * of_memcpy);
+            os << buf;
+        }
+        os << std::flush;
+    }
+
+    std::string name_;
+    const In& independent_;
+    const In& split_;
+    std::vector<impl> impls_;
+};
+
+} // end namespace bench
+
+#endif // TCB_UTF_RANGES_BENCHMARK_SCALING_HPP_INCLUDED
@@ -0,0 +1,265 @@
+// Copyright (c) 2016 Tristan Brindle (tcbrindle at gmail dot com)
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef TCB_UTF_RANGES_CODE_POINT_INDEX_HPP_INCLUDED
+#define TCB_UTF_RANGES_CODE_POINT_INDEX_HPP_INCLUDED
+
+#include <tcb/utf_ranges/detail/code_points.hpp>
+#include <tcb/utf_ranges/detail/contiguous.hpp>
+#include <tcb/utf_ranges/detail/utf.hpp>
+
+#include <range/v3/iterator_range.hpp>
+#include <range/v3/view_facade.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+namespace tcb {
+namespace utf_ranges {
+
+namespace rng = ::ranges::v3;
+
+/// A sparse index of the code points in a buffer of UTF-8 (or UTF-16 or
+/// UTF-32) code units, for finding the n'th code point without counting
+/// from the start every time.
+///
+/// The index records the offset of every stride'th code point, so a lookup
+/// goes straight to the nearest checkpoint before it and counts at most
+/// stride - 1 code points from there (a block at a time, as for
+/// offset_of_code_point()). The index takes sizeof(std::size_t) / stride
+/// bytes per code point: a larger stride gives a smaller index and slower
+/// lookups. Code points are counted as by count_code_points().
+///
+/// The index refers to the buffer, which must outlive it and must not be
+/// modified; build a new index if it is.
+template <typename CharT>
+class basic_code_point_index {
+public:
+    using char_type = CharT;
+
+    static constexpr std::size_t default_stride = 256;
+
+    basic_code_point_index() = default;
+
+    basic_code_point_index(const CharT* first, const CharT* last,
+                           std::size_t stride = default_stride)
+            : first_(first),
+              last_(last),
+              stride_(std::max<std::size_t>(stride, 1))
+    {
+        build();
+    }
+
+    template <typename Range,
+              CONCEPT_REQUIRES_(detail::has_contiguous_data<const Range>())>
+    explicit basic_code_point_index(const Range& range,
+                                    std::size_t stride = default_stride)
+            : basic_code_point_index(detail::contiguous_data(range),
+                                     detail::contiguous_data(range) +
+                                     detail::contiguous_size(range),
+                                     stride)
+    {}
+
+    /// The number of code points
+    std::size_t size() const { return size_; }
+
+    bool empty() const { return size_ == 0; }
+
+    std::size_t stride() const { return stride_; }
+
+    /// The size of the index itself, in bytes
+    std::size_t memory_usage() const
+    {
+        return checkpoints_.size() * sizeof(std::size_t);
+    }
+
+    const CharT* data() const { return first_; }
+
+    /// The number of code units in the buffer
+    std::size_t num_code_units() const
+    {
+        return static_cast<std::size_t>(last_ - first_);
+    }
+
+    /// Returns the offset, in code units, of the start of code point n, or
+    /// num_code_units() if n >= size()
+    std::size_t offset_of(std::size_t n) const
+    {
+        return static_cast<std::size_t>(nth(n) - first_);
+    }
+
+    /// Returns a pointer to the start of code point n, or the end of the
+    /// buffer if n >= size()
+    const CharT* nth(std::size_t n) const
+    {
+        if (n >= size_) {
+            return last_;
+        }
+        const CharT* const checkpoint = first_ + checkpoints_[n / stride_];
+        std::size_t remaining = n % stride_;
+        if (remaining == 0) {
+            return checkpoint;
+        }
+        --remaining;
+        return detail::nth_lead_unit(checkpoint + 1, last_, remaining);
+    }
+
+    /// Returns the number of the code point which includes the code unit at
+    /// offset, or size() if offset >= num_code_units()
+    std::size_t index_of(std::size_t offset) const
+    {
+        if (offset >= num_code_units()) {
+            return size_;
+        }
+        // The last checkpoint at or before offset
+        const auto it = std::upper_bound(checkpoints_.begin(), checkpoints_.end(), offset) - 1;
+        const std::size_t k = static_cast<std::size_t>(it - checkpoints_.begin());
+        return k * stride_ +
+               detail::count_lead_units(first_ + *it + 1, first_ + offset + 1);
+    }
+
+    /// Returns the code units of code points [from, to)
+    rng::iterator_range<const CharT*> code_units(std::size_t from, std::size_t to) const
+    {
+        const CharT* const first = nth(from);
+        return {first, to > from ? nth(to) : first};
+    }
+
+private:
+    void build()
+    {
+        checkpoints_.clear();
+        size_ = 0;
+
+        const CharT* p = first_;
+        while (p != last_) {
+            checkpoints_.push_back(static_cast<std::size_t>(p - first_));
+            std::size_t remaining = stride_ - 1;
+            p = detail::nth_lead_unit(p + 1, last_, remaining);
+            size_ += stride_ - remaining;
+        }
+        checkpoints_.shrink_to_fit();
+    }
+
+    const CharT* first_ = nullptr;
+    const CharT* last_ = nullptr;
+    std::size_t stride_ = default_stride;
+    std::size_t size_ = 0;
+    std::vector<std::size_t> checkpoints_;
+};
+
+template <typename CharT>
+constexpr std::size_t basic_code_point_index<CharT>::default_stride;
+
+using code_point_index = basic_code_point_index<char>;
+using u16_code_point_index = basic_code_point_index<char16_t>;
+
+/// A random-access view of the code points (as UTF-32) of the buffer of a
+/// basic_code_point_index. Moving forward or back one code point at a time
+/// costs about the same as for view::utf32; jumping any distance, or
+/// indexing, goes via the index. Each code point is decoded when it is
+/// read, with invalid sequences becoming U+FFFD.
+template <typename CharT>
+class indexed_code_point_view
+        : public rng::view_facade<indexed_code_point_view<CharT>, rng::finite>
+{
+    friend rng::range_access;
+
+    using index_type = basic_code_point_index<CharT>;
+
+    struct cursor {
+        cursor() = default;
+
+        cursor(const index_type& index, std::size_t n)
+                : index_(&index),
+                  n_(n),
+                  p_(index.nth(n))
+        {}
+
+        char32_t get() const
+        {
+            const CharT* p = p_;
+            const CharT* const last = index_->data() + index_->num_code_units();
+            return detail::decode_or_replace<CharT>(p, last);
+        }
+
+        void next()
+        {
+            const CharT* const last = index_->data() + index_->num_code_units();
+            while (++p_ != last && detail::is_trail_unit(*p_)) {}
+            ++n_;
+        }
+
+        void prev()
+        {
+            const CharT* const first = index_->data();
+            while (--p_ != first && detail::is_trail_unit(*p_)) {}
+            --n_;
+        }
+
+        void advance(std::ptrdiff_t n)
+        {
+            n_ += static_cast<std::size_t>(n);
+            p_ = index_->nth(n_);
+        }
+
+        std::ptrdiff_t distance_to(const cursor& other) const
+        {
+            return static_cast<std::ptrdiff_t>(other.n_) - static_cast<std::ptrdiff_t>(n_);
+        }
+
+        bool equal(const cursor& other) const
+        {
+            return n_ == other.n_;
+        }
+
+        const index_type* index_ = nullptr;
+        std::size_t n_ = 0;
+        const CharT* p_ = nullptr;
+    };
+
+    cursor begin_cursor() const { return {*index_, 0}; }
+
+    cursor end_cursor() const { return {*index_, index_->size()}; }
+
+public:
+    indexed_code_point_view() = default;
+
+    explicit indexed_code_point_view(const index_type& index)
+            : index_(&index)
+    {}
+
+    std::size_t size() const { return index_->size(); }
+
+    const index_type& index() const { return *index_; }
+
+private:
+    const index_type* index_ = nullptr;
+};
+
+namespace view {
+
+struct indexed_utf32_fn {
+    template <typename CharT>
+    indexed_code_point_view<CharT>
+    operator()(const basic_code_point_index<CharT>& index) const
+    {
+        return indexed_code_point_view<CharT>{index};
+    }
+
+    // The view refers to the index, so it must not be made from a temporary
+    template <typename CharT>
+    void operator()(basic_code_point_index<CharT>&& index) const = delete;
+};
+
+/// view::indexed_utf32(index) gives an indexed_code_point_view
+RANGES_INLINE_VARIABLE(indexed_utf32_fn, indexed_utf32);
+
+} // end namespace view
+
+} // end namespace utf_ranges
+} // end namespace tcb
+
+#endif // TCB_UTF_RANGES_CODE_POINT_INDEX_HPP_INCLUDED
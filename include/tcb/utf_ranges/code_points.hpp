@@ -0,0 +1,169 @@
+// Copyright (c) 2016 Tristan Brindle (tcbrindle at gmail dot com)
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef TCB_UTF_RANGES_CODE_POINTS_HPP_INCLUDED
+#define TCB_UTF_RANGES_CODE_POINTS_HPP_INCLUDED
+
+#include <tcb/utf_ranges/detail/code_points.hpp>
+#include <tcb/utf_ranges/detail/contiguous.hpp>
+
+#include <range/v3/range_concepts.hpp>
+#include <range/v3/utility/iterator_concepts.hpp>
+
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+namespace tcb {
+namespace utf_ranges {
+
+namespace rng = ::ranges::v3;
+
+// Counting and moving over code points in UTF-8, UTF-16 or UTF-32 code
+// units, without decoding them. A code point starts at the first code unit,
+// and at every unit which isn't a trail unit (a UTF-8 continuation byte or
+// a UTF-16 low surrogate). For valid UTF, these are exactly the code points
+// which view::utf32 would produce; for invalid UTF, they may not be, since
+// that replaces each stray trail unit with its own U+FFFD.
+
+namespace detail {
+
+template <typename Range,
+          CONCEPT_REQUIRES_(has_contiguous_data<Range>())>
+std::size_t count_code_points_impl(Range& range, priority_tag<1>)
+{
+    const auto first = contiguous_data(range);
+    const std::size_t size = contiguous_size(range);
+    if (size == 0) {
+        return 0;
+    }
+    return 1 + count_lead_units(first + 1, first + size);
+}
+
+template <typename Range>
+std::size_t count_code_points_impl(Range& range, priority_tag<0>)
+{
+    std::size_t count = 0;
+    auto it = rng::begin(range);
+    const auto last = rng::end(range);
+    if (it != last) {
+        ++count;
+        while (++it != last) {
+            count += !is_trail_unit(*it);
+        }
+    }
+    return count;
+}
+
+// Contiguous: skip the current unit, and then n - 1 more lead units
+template <typename CharT>
+std::ptrdiff_t advance_code_points_impl(CharT*& it, std::ptrdiff_t n, CharT* bound,
+                                        priority_tag<1>)
+{
+    if (n <= 0 || it == bound) {
+        return n;
+    }
+    auto remaining = static_cast<std::size_t>(n - 1);
+    const CharT* const p = nth_lead_unit(it + 1, bound, remaining);
+    it += p - it;
+    return p == bound ? static_cast<std::ptrdiff_t>(remaining) : 0;
+}
+
+template <typename Iterator, typename Sentinel>
+std::ptrdiff_t advance_code_points_impl(Iterator& it, std::ptrdiff_t n, Sentinel bound,
+                                        priority_tag<0>)
+{
+    while (n > 0 && it != bound) {
+        while (++it != bound && is_trail_unit(*it)) {}
+        --n;
+    }
+    return n;
+}
+
+template <typename Iterator, typename Sentinel,
+          CONCEPT_REQUIRES_(rng::BidirectionalIterator<Iterator>())>
+std::ptrdiff_t retreat_code_points(Iterator& it, std::ptrdiff_t n, Sentinel bound)
+{
+    while (n < 0 && it != bound) {
+        while (--it != bound && is_trail_unit(*it)) {}
+        ++n;
+    }
+    return n;
+}
+
+template <typename Iterator, typename Sentinel,
+          CONCEPT_REQUIRES_(!rng::BidirectionalIterator<Iterator>())>
+std::ptrdiff_t retreat_code_points(Iterator&, std::ptrdiff_t n, Sentinel)
+{
+    return n;
+}
+
+} // end namespace detail
+
+/// Returns the number of code points in a range of UTF-8, UTF-16 or UTF-32
+/// code units, without decoding them. This is the same as
+/// rng::distance(view::utf32(range)) for valid UTF, but several times faster
+/// for contiguous ranges, which are examined a block at a time.
+template <typename Range,
+          CONCEPT_REQUIRES_(rng::InputRange<Range>())>
+std::size_t count_code_points(Range&& range)
+{
+    return detail::count_code_points_impl(range, detail::priority_tag<1>{});
+}
+
+/// Moves it forward by n code points, or backward if n is negative (which
+/// requires a bidirectional iterator), but not past bound, which must be
+/// the end of the range if n is positive and the start if it is negative.
+/// Returns the number of code points by which it could not be moved (zero,
+/// unless bound was reached first), as rng::advance(it, n, bound) does.
+template <typename Iterator, typename Sentinel,
+          CONCEPT_REQUIRES_(rng::ForwardIterator<Iterator>())>
+std::ptrdiff_t advance_code_points(Iterator& it, std::ptrdiff_t n, Sentinel bound)
+{
+    if (n < 0) {
+        return detail::retreat_code_points(it, n, std::move(bound));
+    }
+    return detail::advance_code_points_impl(it, n, std::move(bound),
+                                            detail::priority_tag<1>{});
+}
+
+/// Returns the offset, in code units, of the start of code point n
+/// (counting from zero) in range, or the size of the range if it has no
+/// more than n code points
+template <typename Range,
+          CONCEPT_REQUIRES_(rng::ForwardRange<Range>() &&
+                            detail::has_contiguous_data<Range>())>
+std::size_t offset_of_code_point(Range&& range, std::size_t n)
+{
+    const auto first = detail::contiguous_data(range);
+    const auto last = first + detail::contiguous_size(range);
+    auto it = first;
+    detail::advance_code_points_impl(it, static_cast<std::ptrdiff_t>(n), last,
+                                     detail::priority_tag<1>{});
+    return static_cast<std::size_t>(it - first);
+}
+
+template <typename Range,
+          CONCEPT_REQUIRES_(rng::ForwardRange<Range>() &&
+                            !detail::has_contiguous_data<Range>())>
+std::size_t offset_of_code_point(Range&& range, std::size_t n)
+{
+    std::size_t offset = 0;
+    auto it = rng::begin(range);
+    const auto last = rng::end(range);
+    if (n == 0 || it == last) {
+        return 0;
+    }
+    for (++it, ++offset; it != last; ++it, ++offset) {
+        if (!detail::is_trail_unit(*it) && --n == 0) {
+            break;
+        }
+    }
+    return offset;
+}
+
+} // end namespace utf_ranges
+} // end namespace tcb
+
+#endif // TCB_UTF_RANGES_CODE_POINTS_HPP_INCLUDED
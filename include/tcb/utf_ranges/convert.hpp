@@ -6,10 +6,15 @@
 #ifndef TCB_UTF_RANGES_CONVERT_HPP_INCLUDED
 #define TCB_UTF_RANGES_CONVERT_HPP_INCLUDED
 
+#include <tcb/utf_ranges/detail/ascii.hpp>
+#include <tcb/utf_ranges/detail/contiguous.hpp>
 #include <tcb/utf_ranges/detail/utf.hpp>
 
 #include <range/v3/range_fwd.hpp>
 
+#include <algorithm>
+#include <array>
+#include <iterator>
 #include <string>
 
 namespace tcb {
@@ -17,19 +22,106 @@ namespace utf_ranges {
 
 namespace rng = ::ranges::v3;
 
+namespace detail {
+
+// Code units are taken from contiguous input this many at a time when
+// converting into anything other than a pointer, going via a buffer on the
+// stack
+constexpr std::size_t convert_chunk_size = 512;
+
+// Converts the code points starting in [first, stop), decoding up to last
+// (so a sequence may straddle stop), and leaves first after the last of
+// them. Runs of ASCII are copied across in bulk, and only the code points
+// in between go through utf_traits.
+template <typename OutCharT, typename InCharT, typename InUnit, typename OutUnit>
+OutUnit* convert_ascii_runs(InUnit*& first, InUnit* stop, InUnit* last, OutUnit* out)
+{
+    while (first < stop) {
+        const std::size_t n = ascii_prefix_length(first, stop);
+        out = copy_ascii(first, n, out);
+        first += n;
+
+        while (first < stop && !is_ascii(*first)) {
+            const code_point c = decode_or_replace<InCharT>(first, last);
+            out = utf_traits<OutCharT>::encode(c, out);
+        }
+    }
+    return out;
+}
+
+template <typename OutCharT, typename InCharT,
+          typename InIter, typename Sentinel, typename OutIter>
+OutIter utf_convert_impl(InIter first, Sentinel last, OutIter out, priority_tag<0>)
+{
+    while (first != last) {
+        const char32_t c = decode_or_replace<InCharT>(first, last);
+        out = utf_traits<OutCharT>::encode(c, out);
+    }
+    return out;
+}
+
+// Contiguous input, any output: convert a chunk at a time into a buffer
+template <typename OutCharT, typename InCharT, typename InUnit, typename OutIter,
+          CONCEPT_REQUIRES_(sizeof(InUnit) == sizeof(InCharT))>
+OutIter utf_convert_impl(InUnit* first, InUnit* last, OutIter out, priority_tag<1>)
+{
+    // The last code point of a chunk may take up to three more input code
+    // units, and each code point is at most max_width output code units
+    std::array<OutCharT, (convert_chunk_size + 3) * utf_traits<OutCharT>::max_width> buf;
+
+    while (first < last) {
+        InUnit* const stop = static_cast<std::size_t>(last - first) > convert_chunk_size
+                             ? first + convert_chunk_size : last;
+        OutCharT* const end = convert_ascii_runs<OutCharT, InCharT>(first, stop, last,
+                                                                   buf.data());
+        out = std::copy(buf.data(), end, std::move(out));
+    }
+    return out;
+}
+
+// Contiguous input and output: convert directly
+template <typename OutCharT, typename InCharT, typename InUnit, typename OutUnit,
+          CONCEPT_REQUIRES_(sizeof(InUnit) == sizeof(InCharT) &&
+                            sizeof(OutUnit) == sizeof(OutCharT))>
+OutUnit* utf_convert_impl(InUnit* first, InUnit* last, OutUnit* out, priority_tag<2>)
+{
+    return convert_ascii_runs<OutCharT, InCharT>(first, last, last, out);
+}
+
+} // end namespace detail
+
 template <typename OutCharT,
           typename InIter, typename Sentinel,
           typename OutIter,
           typename InCharT = typename std::iterator_traits<InIter>::value_type>
 OutIter utf_convert(InIter first, Sentinel last, OutIter out)
 {
-    while (first != last) {
-        const char32_t c = detail::utf_traits<InCharT>::decode(first, last);
-        detail::utf_traits<OutCharT>::encode(c, out);
-    }
-    return out;
+    return detail::utf_convert_impl<OutCharT, InCharT>(std::move(first), std::move(last),
+                                                       std::move(out),
+                                                       detail::priority_tag<2>{});
+}
+
+namespace detail {
+
+template <typename OutCharT, typename InCharT, typename InRange, typename OutIter,
+          CONCEPT_REQUIRES_(has_contiguous_data<InRange>())>
+OutIter utf_convert_range(InRange& range, OutIter out, priority_tag<1>)
+{
+    const auto first = contiguous_data(range);
+    return utf_convert_impl<OutCharT, InCharT>(first, first + contiguous_size(range),
+                                               std::move(out), priority_tag<2>{});
+}
+
+template <typename OutCharT, typename InCharT, typename InRange, typename OutIter>
+OutIter utf_convert_range(InRange& range, OutIter out, priority_tag<0>)
+{
+    return utf_convert<OutCharT, rng::range_iterator_t<InRange>,
+                       rng::range_sentinel_t<InRange>, OutIter, InCharT>(
+            rng::begin(range), rng::end(range), std::move(out));
 }
 
+} // end namespace detail
+
 template <typename OutCharT,
           typename InRange,
           typename OutIter,
@@ -37,15 +129,80 @@ template <typename OutCharT,
           CONCEPT_REQUIRES_(rng::ForwardRange<InRange>())>
 OutIter utf_convert(InRange&& range, OutIter out)
 {
-    return utf_convert<OutCharT, rng::range_iterator_t<InRange>,
-                       rng::range_sentinel_t<InRange>, OutIter, InCharT>(
-            rng::begin(range), rng::end(range), std::move(out));
+    return detail::utf_convert_range<OutCharT, InCharT>(range, std::move(out),
+                                                        detail::priority_tag<1>{});
 }
 
-template <typename Range, typename OutCharT,
-          typename InCharT = rng::range_value_t<Range>>
-std::basic_string<OutCharT>
-to_utf_string(Range&& range)
+/// Returns the number of code units at the start of range which are ASCII,
+/// and so are the same code points in every encoding. Contiguous ranges are
+/// scanned a block at a time.
+template <typename Range,
+          CONCEPT_REQUIRES_(rng::ForwardRange<Range>() &&
+                            detail::has_contiguous_data<Range>())>
+std::size_t ascii_prefix_length(Range&& range)
+{
+    const auto first = detail::contiguous_data(range);
+    return detail::ascii_prefix_length(first, first + detail::contiguous_size(range));
+}
+
+template <typename Range,
+          CONCEPT_REQUIRES_(rng::ForwardRange<Range>() &&
+                            !detail::has_contiguous_data<Range>())>
+std::size_t ascii_prefix_length(Range&& range)
+{
+    std::size_t n = 0;
+    for (auto it = rng::begin(range), last = rng::end(range);
+         it != last && detail::is_ascii(*it); ++it) {
+        ++n;
+    }
+    return n;
+}
+
+namespace detail {
+
+// Contiguous inputs of up to this many code units are converted into a
+// buffer on the stack, and the string is then constructed from it in one
+// go. For short strings, the set-up (reserve(), and a capacity check for
+// every push_back()) costs more than the conversion itself.
+constexpr std::size_t small_string_threshold = 64;
+
+template <typename OutCharT, typename InCharT, typename Range,
+          CONCEPT_REQUIRES_(has_contiguous_data<Range>())>
+std::basic_string<OutCharT> to_utf_string_impl(Range& range, priority_tag<1>)
+{
+    using string_type = std::basic_string<OutCharT>;
+    using ptr_type = contiguous_pointer_t<Range>;
+
+    ptr_type first = contiguous_data(range);
+    const std::size_t size = contiguous_size(range);
+    const ptr_type last = first + size;
+
+    if (size <= small_string_threshold) {
+        // Each input code unit gives at most one encoded code point (a
+        // replacement character, if it is invalid)
+        std::array<OutCharT, small_string_threshold * utf_traits<OutCharT>::max_width> buf;
+        OutCharT* const end = utf_convert<OutCharT, ptr_type, ptr_type, OutCharT*, InCharT>(
+                first, last, buf.data());
+        return string_type(buf.data(), end);
+    }
+
+    // Otherwise, convert a chunk at a time and append() each one, which
+    // copies in bulk rather than checking the capacity for every code unit
+    string_type output;
+    output.reserve(size);
+    std::array<OutCharT, (convert_chunk_size + 3) * utf_traits<OutCharT>::max_width> buf;
+    while (first < last) {
+        const ptr_type stop = static_cast<std::size_t>(last - first) > convert_chunk_size
+                              ? first + convert_chunk_size : last;
+        OutCharT* const end = convert_ascii_runs<OutCharT, InCharT>(first, stop, last,
+                                                                   buf.data());
+        output.append(buf.data(), end);
+    }
+    return output;
+}
+
+template <typename OutCharT, typename InCharT, typename Range>
+std::basic_string<OutCharT> to_utf_string_impl(Range& range, priority_tag<0>)
 {
     using string_type = std::basic_string<OutCharT>;
 
@@ -56,11 +213,24 @@ to_utf_string(Range&& range)
         output.reserve(::ranges::size(range));
     }
 
-    utf_convert<OutCharT>(std::forward<Range>(range), std::back_inserter(output));
+    utf_convert<OutCharT, Range&, std::back_insert_iterator<string_type>, InCharT>(
+            range, std::back_inserter(output));
 
     return output;
 }
 
+} // end namespace detail
+
+template <typename Range, typename OutCharT,
+          typename InCharT = rng::range_value_t<Range>>
+std::basic_string<OutCharT>
+to_utf_string(Range&& range)
+{
+    // Nothing is kept after we return, so it's fine to use the elements of
+    // an rvalue container directly
+    return detail::to_utf_string_impl<OutCharT, InCharT>(range, detail::priority_tag<1>{});
+}
+
 template <typename Range>
 std::string to_u8string(Range&& range)
 {
@@ -80,11 +250,19 @@ std::u32string to_u32string(Range&& range)
 }
 
 template <typename Range>
-std::wstring to_wstsring(Range&& range)
+std::wstring to_wstring(Range&& range)
 {
     return to_utf_string<Range, wchar_t>(std::forward<Range>(range));
 }
 
+/// The original, misspelt name of to_wstring(), kept for existing callers
+template <typename Range>
+[[deprecated("use to_wstring()")]]
+std::wstring to_wstsring(Range&& range)
+{
+    return to_wstring(std::forward<Range>(range));
+}
+
 } // end namespace utf_ranges
 } // end namespace tcb
 
@@ -0,0 +1,280 @@
+// Copyright (c) 2016 Tristan Brindle (tcbrindle at gmail dot com)
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef TCB_UTF_RANGES_DETAIL_ASCII_HPP_INCLUDED
+#define TCB_UTF_RANGES_DETAIL_ASCII_HPP_INCLUDED
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace tcb {
+namespace utf_ranges {
+namespace detail {
+
+// Most text is mostly ASCII, and an ASCII code unit is the same code point
+// in every encoding. So rather than decoding and re-encoding one code point
+// at a time, the contiguous conversions find the length of each run of
+// ASCII with ascii_prefix_length(), and copy it across in bulk with
+// copy_ascii(), widening or narrowing the code units as they go. Only what
+// is left over goes through utf_traits.
+//
+// With SSE2 enabled at compile time (which it always is on x86-64), 16
+// bytes are examined or converted at a time; otherwise we use 64-bit words.
+
+template <typename CharT>
+constexpr bool is_ascii(CharT c) noexcept
+{
+    return static_cast<std::make_unsigned_t<CharT>>(c) < 0x80;
+}
+
+// For each width, the bits which are zero in every ASCII code unit, repeated
+// across a 64-bit word
+template <std::size_t Width>
+constexpr std::uint64_t non_ascii_bits() noexcept
+{
+    return Width == 1 ? 0x8080808080808080ull :
+           Width == 2 ? 0xFF80FF80FF80FF80ull :
+                        0xFFFFFF80FFFFFF80ull;
+}
+
+#if defined(__SSE2__)
+
+// Returns a mask with one bit set for each byte of v, which is set if
+// the code unit containing that byte is ASCII
+inline unsigned ascii_mask(__m128i v, std::integral_constant<std::size_t, 1>) noexcept
+{
+    return ~static_cast<unsigned>(_mm_movemask_epi8(v)) & 0xFFFF;
+}
+
+inline unsigned ascii_mask(__m128i v, std::integral_constant<std::size_t, 2>) noexcept
+{
+    const __m128i high = _mm_and_si128(v, _mm_set1_epi16(static_cast<short>(0xFF80)));
+    return static_cast<unsigned>(
+            _mm_movemask_epi8(_mm_cmpeq_epi16(high, _mm_setzero_si128())));
+}
+
+inline unsigned ascii_mask(__m128i v, std::integral_constant<std::size_t, 4>) noexcept
+{
+    const __m128i high = _mm_and_si128(v, _mm_set1_epi32(static_cast<int>(0xFFFFFF80)));
+    return static_cast<unsigned>(
+            _mm_movemask_epi8(_mm_cmpeq_epi32(high, _mm_setzero_si128())));
+}
+
+inline std::size_t count_trailing_ones(unsigned x) noexcept
+{
+#if defined(__GNUC__)
+    return static_cast<std::size_t>(__builtin_ctz(~x));
+#else
+    std::size_t n = 0;
+    while (x & 1u) {
+        x >>= 1;
+        ++n;
+    }
+    return n;
+#endif
+}
+
+#endif // __SSE2__
+
+/// Returns the number of ASCII code units at the start of [first, last)
+template <typename CharT>
+std::size_t ascii_prefix_length(const CharT* first, const CharT* last) noexcept
+{
+    const CharT* const start = first;
+
+#if defined(__SSE2__)
+    using width = std::integral_constant<std::size_t, sizeof(CharT)>;
+    constexpr std::size_t per_block = 16 / sizeof(CharT);
+
+    // Four blocks at a time while everything is ASCII, since that's the
+    // common case
+    while (static_cast<std::size_t>(last - first) >= 4 * per_block) {
+        const auto p = reinterpret_cast<const __m128i*>(first);
+        const __m128i v = _mm_or_si128(
+                _mm_or_si128(_mm_loadu_si128(p), _mm_loadu_si128(p + 1)),
+                _mm_or_si128(_mm_loadu_si128(p + 2), _mm_loadu_si128(p + 3)));
+        if (ascii_mask(v, width{}) != 0xFFFF) {
+            break;
+        }
+        first += 4 * per_block;
+    }
+
+    while (static_cast<std::size_t>(last - first) >= per_block) {
+        const unsigned mask = ascii_mask(
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(first)), width{});
+        if (mask != 0xFFFF) {
+            return static_cast<std::size_t>(first - start) +
+                   count_trailing_ones(mask) / sizeof(CharT);
+        }
+        first += per_block;
+    }
+#else
+    constexpr std::size_t per_word = 8 / sizeof(CharT);
+
+    while (static_cast<std::size_t>(last - first) >= per_word) {
+        std::uint64_t word;
+        std::memcpy(&word, first, sizeof(word));
+        if (word & non_ascii_bits<sizeof(CharT)>()) {
+            break;
+        }
+        first += per_word;
+    }
+#endif
+
+    while (first != last && is_ascii(*first)) {
+        ++first;
+    }
+    return static_cast<std::size_t>(first - start);
+}
+
+// copy_ascii(): converts n ASCII code units from in to out, which may be of
+// a different width, returning the end of the output
+
+template <typename InCharT, typename OutCharT>
+OutCharT* copy_ascii_scalar(const InCharT* in, std::size_t n, OutCharT* out) noexcept
+{
+    for (std::size_t i = 0; i < n; i++) {
+        out[i] = static_cast<OutCharT>(in[i]);
+    }
+    return out + n;
+}
+
+template <typename InCharT, typename OutCharT,
+          std::enable_if_t<sizeof(InCharT) == sizeof(OutCharT), int> = 0>
+OutCharT* copy_ascii(const InCharT* in, std::size_t n, OutCharT* out) noexcept
+{
+    std::memcpy(out, in, n * sizeof(InCharT));
+    return out + n;
+}
+
+#if defined(__SSE2__)
+
+template <typename InCharT, typename OutCharT>
+OutCharT* copy_ascii_sse2(const InCharT* in, std::size_t n, OutCharT* out,
+                          std::integral_constant<std::size_t, 1>,
+                          std::integral_constant<std::size_t, 2>) noexcept
+{
+    const __m128i zero = _mm_setzero_si128();
+    std::size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+        const auto o = reinterpret_cast<__m128i*>(out + i);
+        _mm_storeu_si128(o, _mm_unpacklo_epi8(v, zero));
+        _mm_storeu_si128(o + 1, _mm_unpackhi_epi8(v, zero));
+    }
+    return copy_ascii_scalar(in + i, n - i, out + i);
+}
+
+template <typename InCharT, typename OutCharT>
+OutCharT* copy_ascii_sse2(const InCharT* in, std::size_t n, OutCharT* out,
+                          std::integral_constant<std::size_t, 1>,
+                          std::integral_constant<std::size_t, 4>) noexcept
+{
+    const __m128i zero = _mm_setzero_si128();
+    std::size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+        const __m128i lo = _mm_unpacklo_epi8(v, zero);
+        const __m128i hi = _mm_unpackhi_epi8(v, zero);
+        const auto o = reinterpret_cast<__m128i*>(out + i);
+        _mm_storeu_si128(o, _mm_unpacklo_epi16(lo, zero));
+        _mm_storeu_si128(o + 1, _mm_unpackhi_epi16(lo, zero));
+        _mm_storeu_si128(o + 2, _mm_unpacklo_epi16(hi, zero));
+        _mm_storeu_si128(o + 3, _mm_unpackhi_epi16(hi, zero));
+    }
+    return copy_ascii_scalar(in + i, n - i, out + i);
+}
+
+template <typename InCharT, typename OutCharT>
+OutCharT* copy_ascii_sse2(const InCharT* in, std::size_t n, OutCharT* out,
+                          std::integral_constant<std::size_t, 2>,
+                          std::integral_constant<std::size_t, 4>) noexcept
+{
+    const __m128i zero = _mm_setzero_si128();
+    std::size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+        const auto o = reinterpret_cast<__m128i*>(out + i);
+        _mm_storeu_si128(o, _mm_unpacklo_epi16(v, zero));
+        _mm_storeu_si128(o + 1, _mm_unpackhi_epi16(v, zero));
+    }
+    return copy_ascii_scalar(in + i, n - i, out + i);
+}
+
+// Narrowing: every unit is below 0x80, so saturating packs are exact
+
+template <typename InCharT, typename OutCharT>
+OutCharT* copy_ascii_sse2(const InCharT* in, std::size_t n, OutCharT* out,
+                          std::integral_constant<std::size_t, 2>,
+                          std::integral_constant<std::size_t, 1>) noexcept
+{
+    std::size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        const auto p = reinterpret_cast<const __m128i*>(in + i);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i),
+                         _mm_packus_epi16(_mm_loadu_si128(p), _mm_loadu_si128(p + 1)));
+    }
+    return copy_ascii_scalar(in + i, n - i, out + i);
+}
+
+template <typename InCharT, typename OutCharT>
+OutCharT* copy_ascii_sse2(const InCharT* in, std::size_t n, OutCharT* out,
+                          std::integral_constant<std::size_t, 4>,
+                          std::integral_constant<std::size_t, 1>) noexcept
+{
+    std::size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        const auto p = reinterpret_cast<const __m128i*>(in + i);
+        const __m128i lo = _mm_packs_epi32(_mm_loadu_si128(p), _mm_loadu_si128(p + 1));
+        const __m128i hi = _mm_packs_epi32(_mm_loadu_si128(p + 2), _mm_loadu_si128(p + 3));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_packus_epi16(lo, hi));
+    }
+    return copy_ascii_scalar(in + i, n - i, out + i);
+}
+
+template <typename InCharT, typename OutCharT>
+OutCharT* copy_ascii_sse2(const InCharT* in, std::size_t n, OutCharT* out,
+                          std::integral_constant<std::size_t, 4>,
+                          std::integral_constant<std::size_t, 2>) noexcept
+{
+    std::size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        const auto p = reinterpret_cast<const __m128i*>(in + i);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i),
+                         _mm_packs_epi32(_mm_loadu_si128(p), _mm_loadu_si128(p + 1)));
+    }
+    return copy_ascii_scalar(in + i, n - i, out + i);
+}
+
+template <typename InCharT, typename OutCharT,
+          std::enable_if_t<sizeof(InCharT) != sizeof(OutCharT), int> = 0>
+OutCharT* copy_ascii(const InCharT* in, std::size_t n, OutCharT* out) noexcept
+{
+    return copy_ascii_sse2(in, n, out,
+                           std::integral_constant<std::size_t, sizeof(InCharT)>{},
+                           std::integral_constant<std::size_t, sizeof(OutCharT)>{});
+}
+
+#else
+
+template <typename InCharT, typename OutCharT,
+          std::enable_if_t<sizeof(InCharT) != sizeof(OutCharT), int> = 0>
+OutCharT* copy_ascii(const InCharT* in, std::size_t n, OutCharT* out) noexcept
+{
+    return copy_ascii_scalar(in, n, out);
+}
+
+#endif // __SSE2__
+
+} // end namespace detail
+} // end namespace utf_ranges
+} // end namespace tcb
+
+#endif // TCB_UTF_RANGES_DETAIL_ASCII_HPP_INCLUDED
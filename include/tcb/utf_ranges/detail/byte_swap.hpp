@@ -0,0 +1,130 @@
+// Copyright (c) 2016 Tristan Brindle (tcbrindle at gmail dot com)
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef TCB_UTF_RANGES_DETAIL_BYTE_SWAP_HPP_INCLUDED
+#define TCB_UTF_RANGES_DETAIL_BYTE_SWAP_HPP_INCLUDED
+
+#include <boost/endian/conversion.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSSE3__)
+#include <tmmintrin.h>
+#endif
+
+namespace tcb {
+namespace utf_ranges {
+namespace detail {
+
+// Bulk byte-swapping kernels. These operate on raw bytes so that they can be
+// used for any code unit type without falling foul of the aliasing rules.
+// The input and output may be the same buffer (for in-place conversion), but
+// must not otherwise overlap.
+//
+// With SSSE3 (or AVX2) enabled at compile time, 16 (or 32) bytes are swapped
+// per instruction using PSHUFB (VPSHUFB); the scalar loop mops up the tail.
+
+template <typename UInt>
+inline void byte_swap_scalar(const unsigned char* in, std::size_t n,
+                             unsigned char* out) noexcept
+{
+    for (std::size_t i = 0; i < n; ++i) {
+        UInt u;
+        std::memcpy(&u, in + i * sizeof(UInt), sizeof(UInt));
+        u = boost::endian::endian_reverse(u);
+        std::memcpy(out + i * sizeof(UInt), &u, sizeof(UInt));
+    }
+}
+
+#if defined(__SSSE3__)
+inline __m128i byte_swap_mask_128(int width) noexcept
+{
+    return width == 2
+        ? _mm_setr_epi8(1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14)
+        : _mm_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+}
+#endif
+
+#if defined(__AVX2__)
+inline __m256i byte_swap_mask_256(int width) noexcept
+{
+    // VPSHUFB shuffles within each 128-bit lane, so the mask is repeated
+    const __m128i m = byte_swap_mask_128(width);
+    return _mm256_inserti128_si256(_mm256_castsi128_si256(m), m, 1);
+}
+#endif
+
+/// Reverses the bytes of each of the n Width-byte units at in, writing the
+/// results to out.
+template <int Width>
+inline void byte_swap_units(const unsigned char* in, std::size_t n,
+                            unsigned char* out) noexcept
+{
+    static_assert(Width == 2 || Width == 4, "");
+    using uint_type = std::conditional_t<Width == 2, std::uint16_t, std::uint32_t>;
+
+    std::size_t i = 0;
+    const std::size_t n_bytes = n * Width;
+
+#if defined(__AVX2__)
+    {
+        const __m256i mask = byte_swap_mask_256(Width);
+        for (; i + 32 <= n_bytes; i += 32) {
+            const __m256i v = _mm256_loadu_si256(
+                    reinterpret_cast<const __m256i*>(in + i));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i),
+                                _mm256_shuffle_epi8(v, mask));
+        }
+    }
+#endif
+#if defined(__SSSE3__)
+    {
+        const __m128i mask = byte_swap_mask_128(Width);
+        for (; i + 16 <= n_bytes; i += 16) {
+            const __m128i v = _mm_loadu_si128(
+                    reinterpret_cast<const __m128i*>(in + i));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i),
+                             _mm_shuffle_epi8(v, mask));
+        }
+    }
+#endif
+
+    byte_swap_scalar<uint_type>(in + i, (n_bytes - i) / Width, out + i);
+}
+
+/// Copies n code units from in to out, reversing the byte order of each
+/// unit if swap is true. Single-byte units are never swapped.
+template <typename T>
+inline void byte_swap_copy(const T* in, std::size_t n, T* out, bool swap) noexcept
+{
+    const auto in_bytes = reinterpret_cast<const unsigned char*>(in);
+    const auto out_bytes = reinterpret_cast<unsigned char*>(out);
+
+    if (!swap || sizeof(T) == 1) {
+        if (in != out && n != 0) {
+            std::memmove(out_bytes, in_bytes, n * sizeof(T));
+        }
+        return;
+    }
+
+    switch (sizeof(T)) {
+    case 2:
+        byte_swap_units<2>(in_bytes, n, out_bytes);
+        break;
+    case 4:
+        byte_swap_units<4>(in_bytes, n, out_bytes);
+        break;
+    }
+}
+
+} // end namespace detail
+} // end namespace utf_ranges
+} // end namespace tcb
+
+#endif // TCB_UTF_RANGES_DETAIL_BYTE_SWAP_HPP_INCLUDED
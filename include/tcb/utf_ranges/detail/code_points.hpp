@@ -0,0 +1,169 @@
+// Copyright (c) 2016 Tristan Brindle (tcbrindle at gmail dot com)
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef TCB_UTF_RANGES_DETAIL_CODE_POINTS_HPP_INCLUDED
+#define TCB_UTF_RANGES_DETAIL_CODE_POINTS_HPP_INCLUDED
+
+#include <cstddef>
+#include <type_traits>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace tcb {
+namespace utf_ranges {
+namespace detail {
+
+// Finding code point boundaries doesn't need any decoding: every code point
+// starts with a "lead" unit, and the only other units are "trail" units,
+// which are easy to recognise on their own:
+//
+//  UTF-8:  continuation bytes, 0x80 to 0xBF
+//  UTF-16: low (trailing) surrogates, 0xDC00 to 0xDFFF
+//  UTF-32: none
+//
+// So counting code points means counting lead units, and we can do that
+// sixteen bytes at a time. For valid UTF this is exactly the number of code
+// points; an invalid trail unit on its own is counted as part of the code
+// point before it.
+
+template <typename CharT>
+constexpr bool is_trail_unit(CharT ci) noexcept
+{
+    return sizeof(CharT) == 1
+           ? (static_cast<std::make_unsigned_t<CharT>>(ci) & 0xC0) == 0x80
+           : sizeof(CharT) == 2
+             ? (static_cast<std::make_unsigned_t<CharT>>(ci) & 0xFC00) == 0xDC00
+             : false;
+}
+
+inline unsigned popcount(unsigned x) noexcept
+{
+#if defined(__GNUC__)
+    return static_cast<unsigned>(__builtin_popcount(x));
+#else
+    unsigned n = 0;
+    for (; x != 0; x &= x - 1) {
+        ++n;
+    }
+    return n;
+#endif
+}
+
+#if defined(__SSE2__)
+
+// Returns a mask with one bit set for each lead unit in v, at the position
+// of the unit's first byte
+
+inline unsigned lead_unit_mask(__m128i v, std::integral_constant<std::size_t, 1>) noexcept
+{
+    // As signed bytes, continuation bytes are -128 to -65
+    return static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpgt_epi8(v, _mm_set1_epi8(-65))));
+}
+
+inline unsigned lead_unit_mask(__m128i v, std::integral_constant<std::size_t, 2>) noexcept
+{
+    const __m128i trail = _mm_cmpeq_epi16(
+            _mm_and_si128(v, _mm_set1_epi16(static_cast<short>(0xFC00))),
+            _mm_set1_epi16(static_cast<short>(0xDC00)));
+    return ~static_cast<unsigned>(_mm_movemask_epi8(trail)) & 0x5555;
+}
+
+inline unsigned lead_unit_mask(__m128i, std::integral_constant<std::size_t, 4>) noexcept
+{
+    return 0x1111;
+}
+
+inline unsigned lowest_set_bit(unsigned x) noexcept
+{
+#if defined(__GNUC__)
+    return static_cast<unsigned>(__builtin_ctz(x));
+#else
+    unsigned n = 0;
+    while (!(x & 1u)) {
+        x >>= 1;
+        ++n;
+    }
+    return n;
+#endif
+}
+
+#endif // __SSE2__
+
+/// Returns the number of lead units in [first, last)
+template <typename CharT>
+std::size_t count_lead_units(const CharT* first, const CharT* last) noexcept
+{
+    if (sizeof(CharT) == 4) {
+        return static_cast<std::size_t>(last - first);
+    }
+
+    std::size_t count = 0;
+
+#if defined(__SSE2__)
+    using width = std::integral_constant<std::size_t, sizeof(CharT)>;
+    constexpr std::size_t per_block = 16 / sizeof(CharT);
+
+    for (; static_cast<std::size_t>(last - first) >= per_block; first += per_block) {
+        count += popcount(lead_unit_mask(
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(first)), width{}));
+    }
+#endif
+
+    for (; first != last; ++first) {
+        count += !is_trail_unit(*first);
+    }
+    return count;
+}
+
+/// Returns the n'th lead unit (counting from zero) in [first, last). If
+/// there are no more than n, returns last, and reduces n by the number
+/// there are.
+template <typename CharT>
+const CharT* nth_lead_unit(const CharT* first, const CharT* last, std::size_t& n) noexcept
+{
+    if (sizeof(CharT) == 4) {
+        const auto size = static_cast<std::size_t>(last - first);
+        if (n < size) {
+            return first + n;
+        }
+        n -= size;
+        return last;
+    }
+
+#if defined(__SSE2__)
+    using width = std::integral_constant<std::size_t, sizeof(CharT)>;
+    constexpr std::size_t per_block = 16 / sizeof(CharT);
+
+    for (; static_cast<std::size_t>(last - first) >= per_block; first += per_block) {
+        unsigned mask = lead_unit_mask(
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(first)), width{});
+        const unsigned count = popcount(mask);
+        if (n < count) {
+            for (; n > 0; n--) {
+                mask &= mask - 1;
+            }
+            return first + lowest_set_bit(mask) / sizeof(CharT);
+        }
+        n -= count;
+    }
+#endif
+
+    for (; first != last; ++first) {
+        if (!is_trail_unit(*first)) {
+            if (n == 0) {
+                return first;
+            }
+            --n;
+        }
+    }
+    return last;
+}
+
+} // end namespace detail
+} // end namespace utf_ranges
+} // end namespace tcb
+
+#endif // TCB_UTF_RANGES_DETAIL_CODE_POINTS_HPP_INCLUDED
@@ -0,0 +1,121 @@
+// Copyright (c) 2016 Tristan Brindle (tcbrindle at gmail dot com)
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef TCB_UTF_RANGES_DETAIL_CONTIGUOUS_HPP_INCLUDED
+#define TCB_UTF_RANGES_DETAIL_CONTIGUOUS_HPP_INCLUDED
+
+#include <range/v3/iterator_range.hpp>
+#include <range/v3/range_concepts.hpp>
+#include <range/v3/range_traits.hpp>
+#include <range/v3/view/all.hpp>
+
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+namespace tcb {
+namespace utf_ranges {
+
+namespace rng = ::ranges::v3;
+
+namespace detail {
+
+// Range-V3 doesn't (yet) have a ContiguousRange concept, so we need to work
+// out for ourselves when it's safe to drop down to raw pointers. We treat a
+// range as contiguous if it has data() and size() members returning a pointer
+// (std::basic_string, std::vector, std::array, string_view etc), if it is a
+// built-in array, or if its iterators are plain pointers (for example,
+// rng::iterator_range<const char*>).
+//
+// Taking a pointer into an rvalue container would leave it dangling, so only
+// lvalues and views (which don't own their elements) qualify.
+
+template <int N>
+struct priority_tag : priority_tag<N - 1> {};
+
+template <>
+struct priority_tag<0> {};
+
+template <typename Range,
+          typename Ptr = decltype(std::declval<Range&>().data()),
+          typename = decltype(std::declval<Range&>().size()),
+          typename = std::enable_if_t<std::is_pointer<Ptr>::value>>
+constexpr Ptr contiguous_data_impl(Range& range, priority_tag<2>)
+{
+    return range.data();
+}
+
+template <typename T, std::size_t N>
+constexpr T* contiguous_data_impl(T (&array)[N], priority_tag<1>)
+{
+    return array;
+}
+
+template <typename Range,
+          typename I = rng::range_iterator_t<Range>,
+          typename = std::enable_if_t<std::is_pointer<I>::value>>
+constexpr I contiguous_data_impl(Range& range, priority_tag<0>)
+{
+    return rng::begin(range);
+}
+
+template <typename Range>
+constexpr auto contiguous_data(Range& range)
+    -> decltype(contiguous_data_impl(range, priority_tag<2>{}))
+{
+    return contiguous_data_impl(range, priority_tag<2>{});
+}
+
+template <typename Range>
+constexpr std::size_t contiguous_size(Range& range)
+{
+    return static_cast<std::size_t>(rng::end(range) - rng::begin(range));
+}
+
+template <typename Range, typename = void>
+struct has_contiguous_data : std::false_type {};
+
+template <typename Range>
+struct has_contiguous_data<Range,
+        decltype(void(contiguous_data(std::declval<Range&>())))>
+        : std::true_type {};
+
+template <typename Range>
+struct is_contiguous_range
+        : std::integral_constant<bool,
+              has_contiguous_data<std::remove_reference_t<Range>>::value &&
+              (std::is_lvalue_reference<Range>::value ||
+               rng::View<std::decay_t<Range>>())> {};
+
+/// Pointer type of the elements of a contiguous range
+template <typename Range>
+using contiguous_pointer_t =
+    decltype(contiguous_data(std::declval<std::remove_reference_t<Range>&>()));
+
+/// Like rng::view::all(), except that contiguous ranges are reduced to a pair
+/// of pointers, so that views built on top of them can tell that their
+/// underlying elements are contiguous in memory
+template <typename Range,
+          CONCEPT_REQUIRES_(is_contiguous_range<Range>())>
+rng::iterator_range<contiguous_pointer_t<Range>> view_all(Range&& range)
+{
+    const auto first = contiguous_data(range);
+    return {first, first + contiguous_size(range)};
+}
+
+template <typename Range,
+          CONCEPT_REQUIRES_(!is_contiguous_range<Range>())>
+rng::view::all_t<Range> view_all(Range&& range)
+{
+    return rng::view::all(std::forward<Range>(range));
+}
+
+template <typename Range>
+using view_all_t = decltype(view_all(std::declval<Range>()));
+
+} // end namespace detail
+} // end namespace utf_ranges
+} // end namespace tcb
+
+#endif // TCB_UTF_RANGES_DETAIL_CONTIGUOUS_HPP_INCLUDED
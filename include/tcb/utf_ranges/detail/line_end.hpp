@@ -0,0 +1,267 @@
+// Copyright (c) 2016 Tristan Brindle (tcbrindle at gmail dot com)
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef TCB_UTF_RANGES_DETAIL_LINE_END_HPP_INCLUDED
+#define TCB_UTF_RANGES_DETAIL_LINE_END_HPP_INCLUDED
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <type_traits>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace tcb {
+namespace utf_ranges {
+
+/// The eight kinds of line terminator recognised by Unicode (UAX #14), plus
+/// none, for the last line of text which doesn't end with one
+enum class line_terminator {
+    none,
+    lf,   ///< Line feed, U+000A
+    cr,   ///< Carriage return, U+000D
+    crlf, ///< CR followed by LF
+    vt,   ///< Vertical tab, U+000B
+    ff,   ///< Form feed, U+000C
+    nel,  ///< Next line, U+0085
+    ls,   ///< Line separator, U+2028
+    ps    ///< Paragraph separator, U+2029
+};
+
+namespace detail {
+
+// Unicode recognises eight line endings: LF, CR, CRLF, VT, FF, NEL (U+0085),
+// LS (U+2028) and PS (U+2029). Apart from LF, which is already what we want,
+// each of these starts with a code unit which we call a "candidate":
+//
+//  UTF-8:    0x0B, 0x0C, 0x0D, 0xC2 (0x85), 0xE2 (0x80 0xA8/0xA9)
+//  UTF-16/32 0x0B, 0x0C, 0x0D, 0x85, 0x2028, 0x2029
+//
+// In UTF-8, 0xC2 and 0xE2 are also the lead bytes of plenty of other
+// characters, so finding a candidate doesn't necessarily mean we've found a
+// line ending; match_line_end() sorts that out.
+//
+// When LF is to be converted to something else, it needs to be treated as a
+// candidate too, which is what the include_lf parameters below are for.
+
+template <typename CharT>
+constexpr bool is_line_end_candidate(CharT ci, bool include_lf = false) noexcept
+{
+    return sizeof(CharT) == 1
+        ? ((static_cast<unsigned char>(ci) >= 0x0B &&
+            static_cast<unsigned char>(ci) <= 0x0D) ||
+           static_cast<unsigned char>(ci) == 0xC2 ||
+           static_cast<unsigned char>(ci) == 0xE2 ||
+           (include_lf && static_cast<unsigned char>(ci) == 0x0A))
+        : ((static_cast<std::uint32_t>(ci) >= 0x0B &&
+            static_cast<std::uint32_t>(ci) <= 0x0D) ||
+           static_cast<std::uint32_t>(ci) == 0x85 ||
+           static_cast<std::uint32_t>(ci) == 0x2028 ||
+           static_cast<std::uint32_t>(ci) == 0x2029 ||
+           (include_lf && static_cast<std::uint32_t>(ci) == 0x0A));
+}
+
+/// Returns an iterator to the first candidate in [first, last), or last
+template <typename I, typename S>
+I find_line_end_candidate(I first, S last, bool include_lf = false)
+{
+    while (first != last && !is_line_end_candidate(*first, include_lf)) {
+        ++first;
+    }
+    return first;
+}
+
+#if defined(__SSE2__)
+
+// In each of these, the "extra" unit is LF if that is to be included, and
+// otherwise a duplicate of CR
+
+inline int line_end_candidate_mask(__m128i v, bool include_lf, char /*width tag*/) noexcept
+{
+    const __m128i m =
+        _mm_or_si128(
+            _mm_or_si128(
+                _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(0x0B)),
+                             _mm_cmpeq_epi8(v, _mm_set1_epi8(0x0C))),
+                _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(0x0D)),
+                             _mm_cmpeq_epi8(v, _mm_set1_epi8(include_lf ? 0x0A : 0x0D)))),
+            _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(static_cast<char>(0xC2))),
+                         _mm_cmpeq_epi8(v, _mm_set1_epi8(static_cast<char>(0xE2)))));
+    return _mm_movemask_epi8(m);
+}
+
+inline int line_end_candidate_mask(__m128i v, bool include_lf, char16_t /*width tag*/) noexcept
+{
+    const __m128i m =
+        _mm_or_si128(
+            _mm_or_si128(
+                _mm_or_si128(_mm_cmpeq_epi16(v, _mm_set1_epi16(0x0B)),
+                             _mm_cmpeq_epi16(v, _mm_set1_epi16(0x0C))),
+                _mm_or_si128(_mm_cmpeq_epi16(v, _mm_set1_epi16(0x0D)),
+                             _mm_cmpeq_epi16(v, _mm_set1_epi16(0x85)))),
+            _mm_or_si128(
+                _mm_or_si128(_mm_cmpeq_epi16(v, _mm_set1_epi16(0x2028)),
+                             _mm_cmpeq_epi16(v, _mm_set1_epi16(0x2029))),
+                _mm_cmpeq_epi16(v, _mm_set1_epi16(include_lf ? 0x0A : 0x0D))));
+    return _mm_movemask_epi8(m);
+}
+
+inline int line_end_candidate_mask(__m128i v, bool include_lf, char32_t /*width tag*/) noexcept
+{
+    const __m128i m =
+        _mm_or_si128(
+            _mm_or_si128(
+                _mm_or_si128(_mm_cmpeq_epi32(v, _mm_set1_epi32(0x0B)),
+                             _mm_cmpeq_epi32(v, _mm_set1_epi32(0x0C))),
+                _mm_or_si128(_mm_cmpeq_epi32(v, _mm_set1_epi32(0x0D)),
+                             _mm_cmpeq_epi32(v, _mm_set1_epi32(0x85)))),
+            _mm_or_si128(
+                _mm_or_si128(_mm_cmpeq_epi32(v, _mm_set1_epi32(0x2028)),
+                             _mm_cmpeq_epi32(v, _mm_set1_epi32(0x2029))),
+                _mm_cmpeq_epi32(v, _mm_set1_epi32(include_lf ? 0x0A : 0x0D))));
+    return _mm_movemask_epi8(m);
+}
+
+inline int count_trailing_zeros(unsigned int x) noexcept
+{
+#if defined(__GNUC__)
+    return __builtin_ctz(x);
+#else
+    int n = 0;
+    while (!(x & 1u)) {
+        x >>= 1;
+        ++n;
+    }
+    return n;
+#endif
+}
+
+template <typename CharT>
+using width_tag_t = std::conditional_t<sizeof(CharT) == 1, char,
+                    std::conditional_t<sizeof(CharT) == 2, char16_t, char32_t>>;
+
+template <typename CharT>
+using enable_if_simd_width_t =
+    std::enable_if_t<sizeof(CharT) == 1 || sizeof(CharT) == 2 || sizeof(CharT) == 4>;
+
+/// Contiguous version: examines 16 bytes at a time
+template <typename CharT, typename = enable_if_simd_width_t<CharT>>
+const CharT* find_line_end_candidate(const CharT* first, const CharT* last,
+                                     bool include_lf = false)
+{
+    constexpr std::size_t per_block = 16 / sizeof(CharT);
+
+    while (static_cast<std::size_t>(last - first) >= per_block) {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first));
+        const int mask = line_end_candidate_mask(v, include_lf, width_tag_t<CharT>{});
+        if (mask != 0) {
+            return first + count_trailing_zeros(static_cast<unsigned>(mask)) / sizeof(CharT);
+        }
+        first += per_block;
+    }
+
+    while (first != last && !is_line_end_candidate(*first, include_lf)) {
+        ++first;
+    }
+    return first;
+}
+
+template <typename CharT, typename = enable_if_simd_width_t<CharT>>
+CharT* find_line_end_candidate(CharT* first, CharT* last, bool include_lf = false)
+{
+    return const_cast<CharT*>(
+            find_line_end_candidate(static_cast<const CharT*>(first),
+                                    static_cast<const CharT*>(last),
+                                    include_lf));
+}
+
+#endif // __SSE2__
+
+/// Given an iterator to a candidate, works out whether it really is the start
+/// of a line ending. If so, advances it past the whole line ending (including
+/// both halves of a CRLF pair) and returns its kind. Otherwise, returns
+/// line_terminator::none without moving it.
+template <typename I, typename S>
+line_terminator match_line_end(I& it, S last)
+{
+    using char_type = typename std::iterator_traits<I>::value_type;
+
+    const auto c = static_cast<std::uint32_t>(
+            static_cast<std::make_unsigned_t<char_type>>(*it));
+
+    switch (c) {
+    case 0x0A:
+        ++it;
+        return line_terminator::lf;
+    case 0x0B:
+        ++it;
+        return line_terminator::vt;
+    case 0x0C:
+        ++it;
+        return line_terminator::ff;
+    case 0x0D:
+        ++it;
+        if (it != last && static_cast<std::uint32_t>(*it) == 0x0A) {
+            ++it;
+            return line_terminator::crlf;
+        }
+        return line_terminator::cr;
+    }
+
+    if (sizeof(char_type) > 1) {
+        switch (c) {
+        case 0x85:
+            ++it;
+            return line_terminator::nel;
+        case 0x2028:
+            ++it;
+            return line_terminator::ls;
+        case 0x2029:
+            ++it;
+            return line_terminator::ps;
+        }
+        return line_terminator::none;
+    }
+
+    // UTF-8 NEL, LS and PS
+    if (c != 0xC2 && c != 0xE2) {
+        return line_terminator::none;
+    }
+
+    I next = it;
+    ++next;
+    if (next == last) {
+        return line_terminator::none;
+    }
+    const auto c2 = static_cast<unsigned char>(*next);
+
+    if (c == 0xC2) {
+        if (c2 == 0x85) {
+            it = ++next;
+            return line_terminator::nel;
+        }
+        return line_terminator::none;
+    }
+
+    if (c2 == 0x80) {
+        ++next;
+        if (next != last) {
+            const auto c3 = static_cast<unsigned char>(*next);
+            if (c3 == 0xA8 || c3 == 0xA9) {
+                it = ++next;
+                return c3 == 0xA8 ? line_terminator::ls : line_terminator::ps;
+            }
+        }
+    }
+
+    return line_terminator::none;
+}
+
+} // end namespace detail
+} // end namespace utf_ranges
+} // end namespace tcb
+
+#endif // TCB_UTF_RANGES_DETAIL_LINE_END_HPP_INCLUDED
@@ -0,0 +1,240 @@
+// Copyright (c) 2016 Tristan Brindle (tcbrindle at gmail dot com)
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef TCB_UTF_RANGES_DETAIL_SNIFF_ENCODING_HPP_INCLUDED
+#define TCB_UTF_RANGES_DETAIL_SNIFF_ENCODING_HPP_INCLUDED
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include <tcb/utf_ranges/detail/utf.hpp>
+
+namespace tcb {
+namespace utf_ranges {
+
+/// The Unicode encoding forms that can be detected in a byte stream
+enum class encoding {
+    utf8,
+    utf16le,
+    utf16be,
+    utf32le,
+    utf32be
+};
+
+/// The result of encoding detection: the encoding form, and the number of
+/// bytes taken up by the byte order mark at the start of the stream (or zero
+/// if there was no BOM, and the encoding was guessed heuristically)
+struct encoding_info {
+    encoding form = encoding::utf8;
+    std::size_t bom_size = 0;
+
+    constexpr bool has_bom() const { return bom_size != 0; }
+};
+
+inline constexpr bool operator==(const encoding_info& lhs, const encoding_info& rhs)
+{
+    return lhs.form == rhs.form && lhs.bom_size == rhs.bom_size;
+}
+
+inline constexpr bool operator!=(const encoding_info& lhs, const encoding_info& rhs)
+{
+    return !(lhs == rhs);
+}
+
+namespace detail {
+
+/// Only this many bytes from the start of a stream are examined
+constexpr std::size_t sniff_size = 4096;
+
+// A truncated sequence at the very end is fine: it's most likely that we
+// just cut the sample off in the middle of a character.
+//
+// C0 controls other than the whitespace ones are rejected too. They hardly
+// ever appear in real text, but BOM-less UTF-16 whose code units are all
+// in U+0100-U+7F7F (such as a Cyrillic word with no spaces) has no zero
+// bytes and is otherwise valid UTF-8, with the high-order bytes of its code
+// units decoding as controls.
+inline bool is_plausible_utf8(const unsigned char* first, const unsigned char* last)
+{
+    while (first != last) {
+        const code_point c = utf_traits<unsigned char>::decode(first, last);
+        if (c == illegal || c == 0) {
+            return false;
+        }
+        if (c < 0x20 && c != '\t' && c != '\n' && c != '\f' && c != '\r') {
+            return false;
+        }
+    }
+    return true;
+}
+
+template <bool BigEndian>
+inline std::uint16_t load_u16(const unsigned char* p)
+{
+    return BigEndian ? static_cast<std::uint16_t>((p[0] << 8) | p[1])
+                     : static_cast<std::uint16_t>((p[1] << 8) | p[0]);
+}
+
+template <bool BigEndian>
+inline std::uint32_t load_u32(const unsigned char* p)
+{
+    return BigEndian
+        ? (std::uint32_t{p[0]} << 24) | (std::uint32_t{p[1]} << 16) |
+          (std::uint32_t{p[2]} << 8) | p[3]
+        : (std::uint32_t{p[3]} << 24) | (std::uint32_t{p[2]} << 16) |
+          (std::uint32_t{p[1]} << 8) | p[0];
+}
+
+template <bool BigEndian>
+inline bool is_plausible_utf16(const unsigned char* first, std::size_t n)
+{
+    n -= n % 2;
+    for (std::size_t i = 0; i < n; i += 2) {
+        const std::uint16_t u = load_u16<BigEndian>(first + i);
+        if (u == 0) {
+            return false;
+        }
+        if (0xD800 <= u && u <= 0xDBFF) {
+            // Lead surrogate: must be followed by a trail surrogate, unless
+            // it's the last unit in the sample
+            if (i + 2 < n) {
+                const std::uint16_t u2 = load_u16<BigEndian>(first + i + 2);
+                if (u2 < 0xDC00 || u2 > 0xDFFF) {
+                    return false;
+                }
+                i += 2;
+            }
+        } else if (0xDC00 <= u && u <= 0xDFFF) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// The number of code units (starting at byte offset, either 0 or 1) whose
+// byte at that offset is the same as in the code unit before. In UTF-16
+// text, most characters come from the same few blocks as their neighbours,
+// so this is much higher for the high-order bytes than the low-order ones.
+inline std::size_t count_repeated_bytes(const unsigned char* p, std::size_t n,
+                                        std::size_t offset)
+{
+    std::size_t count = 0;
+    for (std::size_t i = offset + 2; i < n; i += 2) {
+        count += (p[i] == p[i - 2]);
+    }
+    return count;
+}
+
+template <bool BigEndian>
+inline bool is_plausible_utf32(const unsigned char* first, std::size_t n)
+{
+    n -= n % 4;
+    for (std::size_t i = 0; i < n; i += 4) {
+        const std::uint32_t u = load_u32<BigEndian>(first + i);
+        if (u == 0 || !is_valid_codepoint(u)) {
+            return false;
+        }
+    }
+    return n != 0;
+}
+
+inline encoding_info sniff_bom(const unsigned char* p, std::size_t n)
+{
+    // The UTF-32LE BOM starts with the UTF-16LE BOM, so check for it first
+    if (n >= 4 && p[0] == 0xFF && p[1] == 0xFE && p[2] == 0x00 && p[3] == 0x00) {
+        return {encoding::utf32le, 4};
+    }
+    if (n >= 4 && p[0] == 0x00 && p[1] == 0x00 && p[2] == 0xFE && p[3] == 0xFF) {
+        return {encoding::utf32be, 4};
+    }
+    if (n >= 3 && p[0] == 0xEF && p[1] == 0xBB && p[2] == 0xBF) {
+        return {encoding::utf8, 3};
+    }
+    if (n >= 2 && p[0] == 0xFF && p[1] == 0xFE) {
+        return {encoding::utf16le, 2};
+    }
+    if (n >= 2 && p[0] == 0xFE && p[1] == 0xFF) {
+        return {encoding::utf16be, 2};
+    }
+    return {encoding::utf8, 0};
+}
+
+/// Works out the encoding of the n bytes starting at p, which should be the
+/// start of the stream. A BOM is always believed. Otherwise, we look at the
+/// pattern of zero bytes (which never appear in UTF-8 text, and appear in
+/// the high-order bytes of UTF-16 and UTF-32 code units for ASCII and BMP
+/// characters) and at which interpretations give valid UTF. If nothing
+/// else fits, we assume UTF-8.
+inline encoding_info sniff_encoding(const unsigned char* p, std::size_t n)
+{
+    const encoding_info bom = sniff_bom(p, n);
+    if (bom.has_bom()) {
+        return bom;
+    }
+
+    n = std::min(n, sniff_size);
+
+    std::array<std::size_t, 4> zeros{{}};
+    for (std::size_t i = 0; i < n; i++) {
+        zeros[i % 4] += (p[i] == 0);
+    }
+    const std::size_t total_zeros = zeros[0] + zeros[1] + zeros[2] + zeros[3];
+
+    if (total_zeros == 0 && is_plausible_utf8(p, p + n)) {
+        return {encoding::utf8, 0};
+    }
+
+    // UTF-32: the high byte of every code unit is zero. Checking validity
+    // rules out UTF-16 text which happens to be all Latin-1.
+    if (n >= 4) {
+        const std::size_t units = n / 4;
+        if (zeros[3] >= units && zeros[0] < units && is_plausible_utf32<false>(p, n)) {
+            return {encoding::utf32le, 0};
+        }
+        if (zeros[0] >= units && zeros[3] < units && is_plausible_utf32<true>(p, n)) {
+            return {encoding::utf32be, 0};
+        }
+    }
+
+    // UTF-16: zeros cluster in either the odd or the even bytes
+    const std::size_t even_zeros = zeros[0] + zeros[2];
+    const std::size_t odd_zeros = zeros[1] + zeros[3];
+
+    if (odd_zeros > 2 * even_zeros && is_plausible_utf16<false>(p, n)) {
+        return {encoding::utf16le, 0};
+    }
+    if (even_zeros > 2 * odd_zeros && is_plausible_utf16<true>(p, n)) {
+        return {encoding::utf16be, 0};
+    }
+
+    // No zeros to go on, and not valid UTF-8 (e.g. UTF-16 CJK text): take
+    // whichever UTF-16 byte order gives a valid sequence. If both do, the
+    // high-order bytes are the ones which repeat most; on a tie, prefer
+    // little-endian as by far the most common in the wild.
+    if (total_zeros == 0 && n >= 2) {
+        const bool le = is_plausible_utf16<false>(p, n);
+        const bool be = is_plausible_utf16<true>(p, n);
+        if (le && be) {
+            return count_repeated_bytes(p, n, 0) > count_repeated_bytes(p, n, 1)
+                   ? encoding_info{encoding::utf16be, 0}
+                   : encoding_info{encoding::utf16le, 0};
+        }
+        if (le) {
+            return {encoding::utf16le, 0};
+        }
+        if (be) {
+            return {encoding::utf16be, 0};
+        }
+    }
+
+    return {encoding::utf8, 0};
+}
+
+} // end namespace detail
+} // end namespace utf_ranges
+} // end namespace tcb
+
+#endif // TCB_UTF_RANGES_DETAIL_SNIFF_ENCODING_HPP_INCLUDED
@@ -11,7 +11,10 @@
 #ifndef TCB_UTF_RANGES_DETAIL_UTF_HPP_INCLUDED
 #define TCB_UTF_RANGES_DETAIL_UTF_HPP_INCLUDED
 
+#include <algorithm>
+#include <array>
 #include <cstdint>
+#include <iterator>
 
 namespace tcb {
 namespace utf_ranges {
@@ -142,66 +145,76 @@ struct utf_traits<CharType, 1> {
         return !is_trail(ci);
     }
 
+    //
+    // The valid range of the second byte of a sequence depends on its lead
+    // byte (see table 3-7 of the Unicode Standard). Checking this rules out
+    // overlong forms, surrogates and values above U+10FFFF, so nothing needs
+    // to be checked once the whole sequence has been read.
+    //
+    static constexpr bool is_valid_second(unsigned char lead, unsigned char c)
+    {
+        return lead == 0xE0 ? (c >= 0xA0 && c <= 0xBF) :
+               lead == 0xED ? (c >= 0x80 && c <= 0x9F) :
+               lead == 0xF0 ? (c >= 0x90 && c <= 0xBF) :
+               lead == 0xF4 ? (c >= 0x80 && c <= 0x8F) :
+               is_trail(c);
+    }
+
+    //
+    // Invalid input is rejected as soon as the offending byte is seen, and
+    // that byte is left unconsumed: an illegal sequence is the longest
+    // prefix of a valid one (the "maximal subpart" practice recommended by
+    // Unicode), so a broken sequence never swallows the start of the next
+    // character. Only running out of input gives incomplete.
+    //
     template <typename Iterator, typename Sentinel>
     static constexpr code_point decode(Iterator& p, Sentinel e)
     {
         if (BOOST_LOCALE_UNLIKELY(p == e))
             return incomplete;
 
-        unsigned char lead = *p++;
+        const unsigned char lead = *p++;
 
-        // First byte is fully validated here
-        int trail_size = trail_length(lead);
+        // optimize for ASCII text
+        if (lead < 0x80)
+            return lead;
 
+        // Lone trail bytes, and leads which could only start an overlong
+        // form or a value above U+10FFFF
+        const int trail_size = trail_length(lead);
         if (BOOST_LOCALE_UNLIKELY(trail_size < 0))
             return illegal;
 
-        //
-        // Ok as only ASCII may be of size = 0
-        // also optimize for ASCII text
-        //
-        if (trail_size == 0)
-            return lead;
+        if (BOOST_LOCALE_UNLIKELY(p == e))
+            return incomplete;
+        unsigned char tmp = *p;
+        if (BOOST_LOCALE_UNLIKELY(!is_valid_second(lead, tmp)))
+            return illegal;
+        ++p;
 
-        code_point c = lead & ((1 << (6 - trail_size)) - 1);
+        code_point c = ((lead & ((1 << (6 - trail_size)) - 1)) << 6) | (tmp & 0x3F);
 
         // Read the rest
-        unsigned char tmp{};
         switch (trail_size) {
         case 3:
             if (BOOST_LOCALE_UNLIKELY(p == e))
                 return incomplete;
-            tmp = *p++;
-            if (!is_trail(tmp))
+            tmp = *p;
+            if (BOOST_LOCALE_UNLIKELY(!is_trail(tmp)))
                 return illegal;
+            ++p;
             c = (c << 6) | (tmp & 0x3F);
         case 2:
             if (BOOST_LOCALE_UNLIKELY(p == e))
                 return incomplete;
-            tmp = *p++;
-            if (!is_trail(tmp))
-                return illegal;
-            c = (c << 6) | (tmp & 0x3F);
-        case 1:
-            if (BOOST_LOCALE_UNLIKELY(p == e))
-                return incomplete;
-            tmp = *p++;
-            if (!is_trail(tmp))
+            tmp = *p;
+            if (BOOST_LOCALE_UNLIKELY(!is_trail(tmp)))
                 return illegal;
+            ++p;
             c = (c << 6) | (tmp & 0x3F);
         }
 
-        // Check code point validity: no surrogates and
-        // valid range
-        if (BOOST_LOCALE_UNLIKELY(!is_valid_codepoint(c)))
-            return illegal;
-
-        // make sure it is the most compact representation
-        if (BOOST_LOCALE_UNLIKELY(width(c) != trail_size + 1))
-            return illegal;
-
         return c;
-
     }
 
     template <typename Iterator>
@@ -340,9 +353,11 @@ struct utf_traits<CharType, 2> {
             return illegal;
         if (current == last)
             return incomplete;
-        uint16_t w2 = *current++;
+        // As for UTF-8, a lone lead surrogate mustn't swallow what follows it
+        uint16_t w2 = *current;
         if (w2 < 0xDC00 || 0xDFFF < w2)
             return illegal;
+        ++current;
         return combine_surrogate(w1, w2);
     }
 
@@ -451,6 +466,24 @@ struct utf_traits<CharType, 4> {
 
 }; // utf32
 
+///
+/// \brief The Unicode replacement character, which is substituted for
+/// illegal or incomplete input
+///
+static constexpr code_point replacement_char = 0xFFFDu;
+
+///
+/// \brief Decodes a single code point, replacing an illegal or incomplete
+/// sequence with U+FFFD
+///
+template <typename CharType, typename Iterator, typename Sentinel>
+constexpr code_point decode_or_replace(Iterator& p, Sentinel e)
+{
+    const code_point c = utf_traits<CharType>::decode(p, e);
+    // illegal and incomplete are the only values this large
+    return BOOST_LOCALE_UNLIKELY(c >= incomplete) ? replacement_char : c;
+}
+
 } // end namespace detail
 } // end namespace utf_ranges
 } // end namespace tcb
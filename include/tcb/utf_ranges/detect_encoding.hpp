@@ -0,0 +1,114 @@
+// Copyright (c) 2016 Tristan Brindle (tcbrindle at gmail dot com)
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef TCB_UTF_RANGES_DETECT_ENCODING_HPP_INCLUDED
+#define TCB_UTF_RANGES_DETECT_ENCODING_HPP_INCLUDED
+
+#include <tcb/utf_ranges/convert.hpp>
+#include <tcb/utf_ranges/detail/contiguous.hpp>
+#include <tcb/utf_ranges/detail/sniff_encoding.hpp>
+#include <tcb/utf_ranges/view/bom.hpp>
+#include <tcb/utf_ranges/view/from_bytes.hpp>
+#include <tcb/utf_ranges/view/utf_convert.hpp>
+
+#include <array>
+#include <string>
+
+namespace tcb {
+namespace utf_ranges {
+
+namespace rng = ::ranges::v3;
+
+namespace detail {
+
+template <typename Range,
+          CONCEPT_REQUIRES_(is_contiguous_range<Range>())>
+encoding_info detect_encoding_impl(Range&& bytes)
+{
+    return sniff_encoding(
+            reinterpret_cast<const unsigned char*>(contiguous_data(bytes)),
+            contiguous_size(bytes));
+}
+
+// Not contiguous: copy the start of the range into a buffer first
+template <typename Range,
+          CONCEPT_REQUIRES_(!is_contiguous_range<Range>())>
+encoding_info detect_encoding_impl(Range&& bytes)
+{
+    std::array<unsigned char, sniff_size> buf;
+    std::size_t n = 0;
+    for (auto it = rng::begin(bytes), last = rng::end(bytes);
+         it != last && n < buf.size(); ++it) {
+        buf[n++] = static_cast<unsigned char>(*it);
+    }
+    return sniff_encoding(buf.data(), n);
+}
+
+} // end namespace detail
+
+/// Works out the encoding of a stream of bytes, from its byte order mark if
+/// it has one, and otherwise by examining (at most) the first few kilobytes.
+/// Without a BOM, UTF-16 and UTF-32 are recognised by the pattern of zero
+/// bytes in their code units, and by being valid; if neither fits, the
+/// stream is assumed to be UTF-8.
+template <typename Range,
+          CONCEPT_REQUIRES_(rng::ForwardRange<Range>())>
+encoding_info detect_encoding(Range&& bytes)
+{
+    static_assert(sizeof(rng::range_value_t<Range>) == 1,
+                  "detect_encoding requires a range of bytes");
+    return detail::detect_encoding_impl(std::forward<Range>(bytes));
+}
+
+/// Detects the encoding of a stream of bytes (as for detect_encoding()), and
+/// calls fn with a view which decodes the rest of the stream (after any BOM)
+/// to UTF-32. The decision is made once, up front: each possible encoding
+/// gets its own view type, with the byte order fixed at compile time, so
+/// nothing is re-checked per element. fn must return the same type (or
+/// void) for every encoding.
+///
+/// The view refers to bytes, which may be a temporary (such as the result
+/// of reading a file), since fn is called before decode_any() returns; fn
+/// must not hold on to the view after that.
+template <typename Range, typename Fn,
+          CONCEPT_REQUIRES_(rng::ForwardRange<Range>())>
+decltype(auto) decode_any(Range&& bytes, Fn fn)
+{
+    using boost::endian::order;
+
+    const encoding_info info = detect_encoding(bytes);
+    // bytes is deliberately passed on as an lvalue: views can't own an
+    // rvalue container, and it outlives the call to fn anyway
+    auto rest = view::detail::drop_bom(bytes, info.bom_size);
+
+    switch (info.form) {
+    case encoding::utf16le:
+        return fn(view::utf32(view::from_bytes<char16_t, order::little>(std::move(rest))));
+    case encoding::utf16be:
+        return fn(view::utf32(view::from_bytes<char16_t, order::big>(std::move(rest))));
+    case encoding::utf32le:
+        return fn(view::utf32(view::from_bytes<char32_t, order::little>(std::move(rest))));
+    case encoding::utf32be:
+        return fn(view::utf32(view::from_bytes<char32_t, order::big>(std::move(rest))));
+    case encoding::utf8:
+    default:
+        return fn(view::utf32(std::move(rest)));
+    }
+}
+
+/// Detects the encoding of a stream of bytes, and converts it to a string
+/// with the given code unit type
+template <typename OutCharT, typename Range,
+          CONCEPT_REQUIRES_(rng::ForwardRange<Range>())>
+std::basic_string<OutCharT> decode_any(Range&& bytes)
+{
+    return decode_any(std::forward<Range>(bytes), [](auto&& view) {
+        return to_utf_string<std::remove_reference_t<decltype(view)>&, OutCharT>(view);
+    });
+}
+
+} // end namespace utf_ranges
+} // end namespace tcb
+
+#endif // TCB_UTF_RANGES_DETECT_ENCODING_HPP_INCLUDED
@@ -0,0 +1,179 @@
+// Copyright (c) 2016 Tristan Brindle (tcbrindle at gmail dot com)
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef TCB_UTF_RANGES_ENDIAN_HPP_INCLUDED
+#define TCB_UTF_RANGES_ENDIAN_HPP_INCLUDED
+
+#include <tcb/utf_ranges/detail/byte_swap.hpp>
+#include <tcb/utf_ranges/detail/contiguous.hpp>
+#include <tcb/utf_ranges/view/endian_convert.hpp>
+#include <tcb/utf_ranges/view/from_bytes.hpp>
+
+#include <array>
+#include <algorithm>
+#include <memory>
+
+namespace tcb {
+namespace utf_ranges {
+
+namespace rng = ::ranges::v3;
+
+namespace detail {
+
+// Number of code units converted at a time when the destination isn't a
+// pointer, and we have to go via a temporary buffer
+constexpr std::size_t endian_chunk_size = 256;
+
+template <typename T, typename OutIter>
+OutIter swap_copy_contiguous(const T* first, std::size_t n, OutIter out,
+                             bool swap, std::true_type /*out is T* */)
+{
+    byte_swap_copy(first, n, out, swap);
+    return out + n;
+}
+
+template <typename T, typename OutIter>
+OutIter swap_copy_contiguous(const T* first, std::size_t n, OutIter out,
+                             bool swap, std::false_type /*out is T* */)
+{
+    if (!swap) {
+        return std::copy(first, first + n, std::move(out));
+    }
+
+    std::array<T, endian_chunk_size> buf;
+    while (n > 0) {
+        const std::size_t len = std::min(n, buf.size());
+        byte_swap_copy(first, len, buf.data(), true);
+        out = std::copy(buf.data(), buf.data() + len, std::move(out));
+        first += len;
+        n -= len;
+    }
+    return out;
+}
+
+template <typename T, typename OutIter>
+OutIter swap_copy_contiguous(const T* first, std::size_t n, OutIter out, bool swap)
+{
+    return swap_copy_contiguous(first, n, std::move(out), swap,
+                                std::is_same<OutIter, T*>{});
+}
+
+// Contiguous source: straight into the kernel
+template <typename Range, typename OutIter,
+          CONCEPT_REQUIRES_(is_contiguous_range<Range>())>
+OutIter endian_copy_impl(Range&& range, OutIter out, bool swap, priority_tag<2>)
+{
+    return swap_copy_contiguous(contiguous_data(range), contiguous_size(range),
+                                std::move(out), swap);
+}
+
+// An endian_convert view of a contiguous range: combine its swap with ours,
+// and run the kernel over the underlying data
+template <typename Range, typename OutIter,
+          typename View = std::decay_t<Range>,
+          CONCEPT_REQUIRES_(is_endian_convert_view<View>() &&
+                            is_contiguous_range<decltype(std::declval<View&>().base())>())>
+OutIter endian_copy_impl(Range&& range, OutIter out, bool swap, priority_tag<1>)
+{
+    auto base = range.base();
+    return swap_copy_contiguous(contiguous_data(base), contiguous_size(base),
+                                std::move(out), swap != range.needs_swap());
+}
+
+// Likewise for a (compile-time) byte_swap view of a contiguous range
+template <typename Range, typename OutIter,
+          typename View = std::decay_t<Range>,
+          CONCEPT_REQUIRES_(is_byte_swap_view<View>() &&
+                            is_contiguous_range<decltype(std::declval<View&>().base())>())>
+OutIter endian_copy_impl(Range&& range, OutIter out, bool swap, priority_tag<1>)
+{
+    auto base = range.base();
+    return swap_copy_contiguous(contiguous_data(base), contiguous_size(base),
+                                std::move(out), !swap);
+}
+
+// A from_bytes view over contiguous bytes: copy a block of bytes at a time
+// into a buffer and swap them there
+template <typename Range, typename OutIter,
+          typename View = std::decay_t<Range>,
+          CONCEPT_REQUIRES_(is_from_bytes_view<View>() &&
+                            std::is_pointer<rng::range_iterator_t<
+                                    decltype(std::declval<View&>().base())>>())>
+OutIter endian_copy_impl(Range&& range, OutIter out, bool swap, priority_tag<1>)
+{
+    using char_type = rng::range_value_t<View>;
+
+    const unsigned char* first = range.unit_bytes_begin();
+    const bool view_swaps = range.reassembles_swapped();
+    std::size_t n = rng::size(range);
+
+    std::array<char_type, endian_chunk_size> buf;
+    while (n > 0) {
+        const std::size_t len = std::min(n, buf.size());
+        std::memcpy(buf.data(), first, len * sizeof(char_type));
+        byte_swap_copy(buf.data(), len, buf.data(), swap != view_swaps);
+        out = std::copy(buf.data(), buf.data() + len, std::move(out));
+        first += len * sizeof(char_type);
+        n -= len;
+    }
+    return out;
+}
+
+// Anything else: one element at a time
+template <typename Range, typename OutIter>
+OutIter endian_copy_impl(Range&& range, OutIter out, bool swap, priority_tag<0>)
+{
+    for (auto&& c : range) {
+        const auto v = static_cast<rng::range_value_t<Range>>(c);
+        *out = swap ? endian_reverse(make_swap_wrapper(v)).value : v;
+        ++out;
+    }
+    return out;
+}
+
+} // end namespace detail
+
+/// Converts the elements of a contiguous range of code units (such as a
+/// std::u16string) in place, from the given source byte order to DestOrder.
+template <boost::endian::order DestOrder = boost::endian::order::native,
+          typename Range,
+          CONCEPT_REQUIRES_(detail::is_contiguous_range<Range>())>
+void endian_convert_inplace(Range&& range,
+                            boost::endian::order src_order = boost::endian::order::native)
+{
+    using value_type = rng::range_value_t<Range>;
+    static_assert(!std::is_const<std::remove_reference_t<rng::range_reference_t<Range>>>::value,
+                  "endian_convert_inplace requires a mutable range");
+
+    const std::size_t n = detail::contiguous_size(range);
+    if (n == 0 || src_order == DestOrder) {
+        return;
+    }
+
+    // Not data(), which is const-only for std::basic_string before C++17
+    value_type* first = std::addressof(*rng::begin(range));
+    detail::byte_swap_copy(first, n, first, true);
+}
+
+/// Copies the elements of the given range to out, converting each from the
+/// given source byte order to DestOrder.
+///
+/// Contiguous input (including endian_convert, byte_swap and from_bytes views of
+/// contiguous data) is converted in bulk using the SIMD kernel where
+/// available; other ranges are converted one element at a time.
+template <boost::endian::order DestOrder = boost::endian::order::native,
+          typename Range, typename OutIter,
+          CONCEPT_REQUIRES_(rng::InputRange<Range>())>
+OutIter endian_convert_copy(Range&& range, OutIter out,
+                            boost::endian::order src_order = boost::endian::order::native)
+{
+    const bool swap = sizeof(rng::range_value_t<Range>) > 1 && src_order != DestOrder;
+    return detail::endian_copy_impl(std::forward<Range>(range), std::move(out),
+                                    swap, detail::priority_tag<2>{});
+}
+
+} // end namespace utf_ranges
+} // end namespace tcb
+
+#endif // TCB_UTF_RANGES_ENDIAN_HPP_INCLUDED
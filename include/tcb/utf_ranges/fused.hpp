@@ -0,0 +1,338 @@
+// Copyright (c) 2016 Tristan Brindle (tcbrindle at gmail dot com)
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef TCB_UTF_RANGES_FUSED_HPP_INCLUDED
+#define TCB_UTF_RANGES_FUSED_HPP_INCLUDED
+
+#include <tcb/utf_ranges/detail/ascii.hpp>
+#include <tcb/utf_ranges/detail/byte_swap.hpp>
+#include <tcb/utf_ranges/detail/contiguous.hpp>
+#include <tcb/utf_ranges/detail/utf.hpp>
+#include <tcb/utf_ranges/line_end.hpp>
+#include <tcb/utf_ranges/view/bom.hpp>
+#include <tcb/utf_ranges/view/bytes.hpp>
+#include <tcb/utf_ranges/view/endian_convert.hpp>
+#include <tcb/utf_ranges/view/from_bytes.hpp>
+#include <tcb/utf_ranges/view/line_end_transform.hpp>
+#include <tcb/utf_ranges/view/utf_convert.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+namespace tcb {
+namespace utf_ranges {
+
+namespace rng = ::ranges::v3;
+
+namespace detail {
+
+// Each stage of a fused pipeline works on (at most) this many elements at a
+// time, in a buffer on the stack
+constexpr std::size_t fused_chunk_size = 1024;
+
+// for_each_chunk(range, fn) calls fn(const T* p, std::size_t n) for
+// successive runs of the elements of range, which together make up exactly
+// the sequence that iterating over the range would produce. Views which
+// we know about are taken apart with base(), and their transformation is
+// applied a whole chunk at a time; anything else is iterated over as usual.
+
+template <typename Range, typename Fn>
+void for_each_chunk(Range&& range, Fn&& fn);
+
+// Anything else: gather elements into a buffer
+template <typename Range, typename Fn>
+void for_each_chunk_impl(Range& range, Fn& fn, priority_tag<0>)
+{
+    using value_type = rng::range_value_t<Range>;
+
+    std::array<value_type, fused_chunk_size> buf;
+    std::size_t n = 0;
+
+    for (auto it = rng::begin(range), last = rng::end(range); it != last; ++it) {
+        buf[n++] = *it;
+        if (n == buf.size()) {
+            fn(static_cast<const value_type*>(buf.data()), n);
+            n = 0;
+        }
+    }
+
+    if (n != 0) {
+        fn(static_cast<const value_type*>(buf.data()), n);
+    }
+}
+
+// Code units in memory: nothing to do
+template <typename Range, typename Fn,
+          CONCEPT_REQUIRES_(is_contiguous_range<Range&>())>
+void for_each_chunk_impl(Range& range, Fn& fn, priority_tag<2>)
+{
+    const auto first = contiguous_data(range);
+    fn(static_cast<const rng::range_value_t<Range>*>(first), contiguous_size(range));
+}
+
+// Transcoding: decode straight from each incoming chunk. A sequence which
+// straddles two chunks is assembled in a small carry buffer; since decode()
+// only reports an incomplete sequence when it runs out of input, retrying
+// once more input has arrived gives exactly what decoding the whole range
+// in one go would. Runs of ASCII are copied (widening or narrowing as
+// necessary) without being decoded at all, and when the input and output
+// encodings are the same, other valid sequences are copied rather than
+// re-encoded.
+template <typename Range, typename Fn,
+          typename View = std::decay_t<Range>,
+          CONCEPT_REQUIRES_(is_utf_convert_view<View>())>
+void for_each_chunk_impl(Range& range, Fn& fn, priority_tag<1>)
+{
+    using in_char_type = rng::range_value_t<decltype(range.base())>;
+    using out_char_type = rng::range_value_t<View>;
+    using in_traits = utf_traits<in_char_type>;
+    using out_traits = utf_traits<out_char_type>;
+
+    constexpr bool same_width = sizeof(in_char_type) == sizeof(out_char_type);
+
+    std::array<out_char_type, fused_chunk_size> out_buf;
+    out_char_type* out = out_buf.data();
+    out_char_type* const out_limit = out_buf.data() + out_buf.size() - out_traits::max_width;
+
+    const auto flush_if_full = [&] {
+        if (out > out_limit) {
+            fn(static_cast<const out_char_type*>(out_buf.data()),
+               static_cast<std::size_t>(out - out_buf.data()));
+            out = out_buf.data();
+        }
+    };
+
+    const auto emit = [&](code_point c) {
+        if (BOOST_LOCALE_UNLIKELY(c >= incomplete)) {
+            c = replacement_char;
+        }
+        out = out_traits::encode(c, out);
+        flush_if_full();
+    };
+
+    std::array<in_char_type, 4> carry;
+    std::size_t num_carried = 0;
+
+    const auto drain_carry = [&](bool at_end) {
+        while (num_carried != 0) {
+            const in_char_type* p = carry.data();
+            const code_point c = in_traits::decode(p, carry.data() + num_carried);
+            if (c == incomplete && !at_end) {
+                return;
+            }
+            emit(c);
+            const std::size_t used = p - carry.data();
+            std::copy(carry.data() + used, carry.data() + num_carried, carry.data());
+            num_carried -= used;
+        }
+    };
+
+    for_each_chunk(range.base(), [&](const in_char_type* first, std::size_t n) {
+        const in_char_type* const last = first + n;
+
+        while (num_carried != 0 && first != last) {
+            carry[num_carried++] = *first++;
+            drain_carry(false);
+        }
+
+        while (first != last) {
+            // A run of ASCII is copied across in bulk, as far as there is
+            // room in the output buffer each time
+            std::size_t ascii_run = ascii_prefix_length(first, last);
+            while (ascii_run != 0) {
+                const auto room = static_cast<std::size_t>(out_buf.data() + out_buf.size() - out);
+                const std::size_t len = std::min(ascii_run, room);
+                out = copy_ascii(first, len, out);
+                first += len;
+                ascii_run -= len;
+                flush_if_full();
+            }
+
+            // Then code points one at a time, up to the next ASCII unit
+            while (first != last && !is_ascii(*first)) {
+                const in_char_type* const start = first;
+                const code_point c = in_traits::decode(first, last);
+                if (BOOST_LOCALE_UNLIKELY(c == incomplete)) {
+                    num_carried = std::copy(start, last, carry.data()) - carry.data();
+                    first = last;
+                    break;
+                }
+                if (same_width && BOOST_LOCALE_LIKELY(c != illegal)) {
+                    out = std::copy(start, first, out);
+                    flush_if_full();
+                } else {
+                    emit(c);
+                }
+            }
+        }
+    });
+
+    drain_carry(true);
+
+    if (out != out_buf.data()) {
+        fn(static_cast<const out_char_type*>(out_buf.data()),
+           static_cast<std::size_t>(out - out_buf.data()));
+    }
+}
+
+template <typename T, typename Fn>
+void swap_chunks(const T* first, std::size_t n, Fn& fn)
+{
+    std::array<T, fused_chunk_size> buf;
+    while (n > 0) {
+        const std::size_t len = std::min(n, buf.size());
+        byte_swap_copy(first, len, buf.data(), true);
+        fn(static_cast<const T*>(buf.data()), len);
+        first += len;
+        n -= len;
+    }
+}
+
+// Endian conversion: swap each chunk in bulk (or pass it through untouched)
+template <typename Range, typename Fn,
+          typename View = std::decay_t<Range>,
+          CONCEPT_REQUIRES_(is_endian_convert_view<View>())>
+void for_each_chunk_impl(Range& range, Fn& fn, priority_tag<1>)
+{
+    using value_type = rng::range_value_t<View>;
+
+    if (!range.needs_swap()) {
+        for_each_chunk(range.base(), fn);
+        return;
+    }
+
+    for_each_chunk(range.base(), [&](const value_type* first, std::size_t n) {
+        swap_chunks(first, n, fn);
+    });
+}
+
+template <typename Range, typename Fn,
+          typename View = std::decay_t<Range>,
+          CONCEPT_REQUIRES_(is_byte_swap_view<View>())>
+void for_each_chunk_impl(Range& range, Fn& fn, priority_tag<1>)
+{
+    using value_type = rng::range_value_t<View>;
+
+    for_each_chunk(range.base(), [&](const value_type* first, std::size_t n) {
+        swap_chunks(first, n, fn);
+    });
+}
+
+// Reassembling code units from contiguous bytes: copy them out a block at a
+// time, swapping if necessary
+template <typename Range, typename Fn,
+          typename View = std::decay_t<Range>,
+          CONCEPT_REQUIRES_(is_from_bytes_view<View>() &&
+                            std::is_pointer<rng::range_iterator_t<
+                                    decltype(std::declval<View&>().base())>>())>
+void for_each_chunk_impl(Range& range, Fn& fn, priority_tag<1>)
+{
+    using value_type = rng::range_value_t<View>;
+
+    const unsigned char* first = range.unit_bytes_begin();
+    const bool swap = range.reassembles_swapped();
+    std::size_t n = rng::size(range);
+
+    std::array<value_type, fused_chunk_size> buf;
+    while (n > 0) {
+        const std::size_t len = std::min(n, buf.size());
+        std::memcpy(buf.data(), first, len * sizeof(value_type));
+        byte_swap_copy(buf.data(), len, buf.data(), swap);
+        fn(static_cast<const value_type*>(buf.data()), len);
+        first += len * sizeof(value_type);
+        n -= len;
+    }
+}
+
+// A BOM (or other short prefix), followed by the underlying range
+template <typename Range, typename Fn,
+          typename View = std::decay_t<Range>,
+          CONCEPT_REQUIRES_(view::detail::is_bom_prefix_view<View>())>
+void for_each_chunk_impl(Range& range, Fn& fn, priority_tag<1>)
+{
+    const auto prefix = range.prefix();
+    if (prefix.size() != 0) {
+        fn(prefix.begin(), prefix.size());
+    }
+    for_each_chunk(range.base(), fn);
+}
+
+// Line ending transformation: run each chunk through the transformer. Each
+// input code unit gives at most two output code units, plus at most two
+// more which were held back from the previous chunk.
+template <typename Range, typename Fn,
+          typename View = std::decay_t<Range>,
+          CONCEPT_REQUIRES_(is_line_end_transform_view<View>())>
+void for_each_chunk_impl(Range& range, Fn& fn, priority_tag<1>)
+{
+    using value_type = rng::range_value_t<View>;
+    constexpr std::size_t max_input = (fused_chunk_size - 2) / 2;
+
+    line_end_transformer<value_type> transformer{range.target()};
+    std::array<value_type, fused_chunk_size> buf;
+
+    for_each_chunk(range.base(), [&](const value_type* first, std::size_t n) {
+        while (n > 0) {
+            const std::size_t len = std::min(n, max_input);
+            value_type* out = transformer.transform(first, first + len, buf.data());
+            fn(static_cast<const value_type*>(buf.data()),
+               static_cast<std::size_t>(out - buf.data()));
+            first += len;
+            n -= len;
+        }
+    });
+
+    value_type* out = transformer.flush(buf.data());
+    if (out != buf.data()) {
+        fn(static_cast<const value_type*>(buf.data()),
+           static_cast<std::size_t>(out - buf.data()));
+    }
+}
+
+// Bytes: just reinterpret the chunks of the underlying range
+template <typename Range, typename Fn,
+          typename View = std::decay_t<Range>,
+          CONCEPT_REQUIRES_(is_bytes_view<View>())>
+void for_each_chunk_impl(Range& range, Fn& fn, priority_tag<1>)
+{
+    using base_value_type = rng::range_value_t<decltype(range.base())>;
+
+    for_each_chunk(range.base(), [&](const base_value_type* first, std::size_t n) {
+        fn(reinterpret_cast<const unsigned char*>(first), n * sizeof(base_value_type));
+    });
+}
+
+template <typename Range, typename Fn>
+void for_each_chunk(Range&& range, Fn&& fn)
+{
+    for_each_chunk_impl(range, fn, priority_tag<2>{});
+}
+
+} // end namespace detail
+
+/// Copies the elements of range to out, exactly as rng::copy() would.
+///
+/// Where range is a chain of this library's views (for example
+/// consume_bom | utf16 | add_bom | endian_convert<big> | bytes, or
+/// utf8 | line_end_transform) over some source range, the chain is taken
+/// apart and each stage is applied in bulk to chunks of around a thousand
+/// code units at a time, rather than element by element through a stack of
+/// nested iterators. If the source is contiguous in memory, the first
+/// stage reads from it directly; otherwise it is first gathered into a
+/// buffer.
+template <typename Range, typename OutIter,
+          CONCEPT_REQUIRES_(rng::InputRange<Range>())>
+OutIter fused_copy(Range&& range, OutIter out)
+{
+    detail::for_each_chunk(range, [&](const auto* first, std::size_t n) {
+        out = std::copy(first, first + n, std::move(out));
+    });
+    return out;
+}
+
+} // end namespace utf_ranges
+} // end namespace tcb
+
+#endif // TCB_UTF_RANGES_FUSED_HPP_INCLUDED
@@ -0,0 +1,242 @@
+// Copyright (c) 2016 Tristan Brindle (tcbrindle at gmail dot com)
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef TCB_UTF_RANGES_LINE_END_HPP_INCLUDED
+#define TCB_UTF_RANGES_LINE_END_HPP_INCLUDED
+
+#include <tcb/utf_ranges/detail/contiguous.hpp>
+#include <tcb/utf_ranges/detail/line_end.hpp>
+
+#include <range/v3/range_concepts.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+
+namespace tcb {
+namespace utf_ranges {
+
+namespace rng = ::ranges::v3;
+
+/// The line ending to convert to
+enum class line_end {
+    lf,      ///< "\n", as used by Unix and by C++ text streams
+    crlf,    ///< "\r\n", as used by Windows and many network protocols
+    cr,      ///< "\r", as used by classic Mac OS
+    preserve ///< Leave line endings as they are
+};
+
+/// Converts all eight Unicode line endings in a stream of UTF-8, UTF-16 or
+/// UTF-32 code units to the given target.
+///
+/// The transformer keeps enough state to be fed its input in arbitrary
+/// chunks: a CR at the end of one chunk and an LF at the start of the next
+/// are still treated as a single CRLF, and likewise for the multi-byte UTF-8
+/// forms of NEL, LS and PS. The output is the same wherever the chunk
+/// boundaries fall. Call flush() once at the end of the input to write out
+/// anything still being held back.
+template <typename CharT>
+class line_end_transformer {
+    static_assert(sizeof(CharT) == 1 || sizeof(CharT) == 2 || sizeof(CharT) == 4,
+                  "line_end_transformer requires UTF-8, UTF-16 or UTF-32 code units");
+
+public:
+    using char_type = CharT;
+
+    /// The most code units that a single call to put() or flush() can write
+    static constexpr std::size_t max_output = 4;
+
+    line_end_transformer() = default;
+
+    explicit line_end_transformer(line_end target)
+        : target_(target)
+    {}
+
+    line_end target() const { return target_; }
+
+    /// Returns true if some input is being held back until we know whether
+    /// it forms part of a line ending
+    bool has_pending() const { return num_pending_ != 0; }
+
+    /// Discards any pending input
+    void reset() { num_pending_ = 0; }
+
+    /// Processes a single code unit
+    template <typename OutIter>
+    OutIter put(CharT c, OutIter out)
+    {
+        if (target_ == line_end::preserve) {
+            *out = c;
+            return ++out;
+        }
+
+        const std::uint32_t u = to_uint(c);
+
+        if (num_pending_ != 0) {
+            if (to_uint(pending_[0]) == 0x0D) {
+                num_pending_ = 0;
+                out = write_line_end(std::move(out));
+                if (u == 0x0A) {
+                    return out;
+                }
+            } else {
+                // Part of a UTF-8 NEL (C2 85), LS (E2 80 A8) or PS (E2 80 A9)
+                const std::uint32_t lead = to_uint(pending_[0]);
+                if (num_pending_ == 1 && lead == 0xE2 && u == 0x80) {
+                    pending_[num_pending_++] = c;
+                    return out;
+                }
+                if ((num_pending_ == 1 && lead == 0xC2 && u == 0x85) ||
+                    (num_pending_ == 2 && (u == 0xA8 || u == 0xA9))) {
+                    num_pending_ = 0;
+                    return write_line_end(std::move(out));
+                }
+                out = write_pending(std::move(out));
+            }
+        }
+
+        if (u == 0x0D || (sizeof(CharT) == 1 && (u == 0xC2 || u == 0xE2))) {
+            pending_[num_pending_++] = c;
+            return out;
+        }
+
+        if ((u >= 0x0A && u <= 0x0C) ||
+            (sizeof(CharT) > 1 && (u == 0x85 || u == 0x2028 || u == 0x2029))) {
+            return write_line_end(std::move(out));
+        }
+
+        *out = c;
+        return ++out;
+    }
+
+    /// Processes the chunk [first, last). When the chunk is contiguous in
+    /// memory, runs of code units which can't be part of a line ending are
+    /// found with a vectorised scan and copied in bulk.
+    template <typename I, typename S, typename OutIter>
+    OutIter transform(I first, S last, OutIter out)
+    {
+        return transform_impl(std::move(first), std::move(last), std::move(out),
+                              std::integral_constant<bool,
+                                  std::is_pointer<I>::value && std::is_same<I, S>::value>{});
+    }
+
+    /// Processes the chunk given by range
+    template <typename Range, typename OutIter,
+              CONCEPT_REQUIRES_(rng::InputRange<Range>())>
+    OutIter transform(Range&& range, OutIter out)
+    {
+        return transform(rng::begin(range), rng::end(range), std::move(out));
+    }
+
+    /// Signals the end of the input, writing out anything still pending
+    template <typename OutIter>
+    OutIter flush(OutIter out)
+    {
+        if (num_pending_ != 0) {
+            if (to_uint(pending_[0]) == 0x0D) {
+                num_pending_ = 0;
+                return write_line_end(std::move(out));
+            }
+            out = write_pending(std::move(out));
+        }
+        return out;
+    }
+
+private:
+    static std::uint32_t to_uint(CharT c)
+    {
+        return static_cast<std::uint32_t>(static_cast<std::make_unsigned_t<CharT>>(c));
+    }
+
+    template <typename OutIter>
+    OutIter write_line_end(OutIter out) const
+    {
+        switch (target_) {
+        case line_end::crlf:
+            *out = static_cast<CharT>('\r');
+            ++out;
+            *out = static_cast<CharT>('\n');
+            return ++out;
+        case line_end::cr:
+            *out = static_cast<CharT>('\r');
+            return ++out;
+        default:
+            *out = static_cast<CharT>('\n');
+            return ++out;
+        }
+    }
+
+    template <typename OutIter>
+    OutIter write_pending(OutIter out)
+    {
+        for (std::uint8_t i = 0; i < num_pending_; i++) {
+            *out = pending_[i];
+            ++out;
+        }
+        num_pending_ = 0;
+        return out;
+    }
+
+    template <typename I, typename S, typename OutIter>
+    OutIter transform_impl(I first, S last, OutIter out, std::true_type /*contiguous*/)
+    {
+        if (target_ == line_end::preserve) {
+            return std::copy(first, last, std::move(out));
+        }
+
+        const bool include_lf = target_ != line_end::lf;
+
+        while (first != last) {
+            if (num_pending_ == 0) {
+                const I cand = detail::find_line_end_candidate(first, last, include_lf);
+                out = std::copy(first, cand, std::move(out));
+                first = cand;
+                if (first == last) {
+                    break;
+                }
+            }
+            out = put(static_cast<CharT>(*first), std::move(out));
+            ++first;
+        }
+
+        return out;
+    }
+
+    template <typename I, typename S, typename OutIter>
+    OutIter transform_impl(I first, S last, OutIter out, std::false_type /*contiguous*/)
+    {
+        for (; first != last; ++first) {
+            out = put(static_cast<CharT>(*first), std::move(out));
+        }
+        return out;
+    }
+
+    line_end target_ = line_end::lf;
+    std::array<CharT, 2> pending_{};
+    std::uint8_t num_pending_ = 0;
+};
+
+template <typename CharT>
+constexpr std::size_t line_end_transformer<CharT>::max_output;
+
+/// Copies the given range of UTF-8, UTF-16 or UTF-32 code units to out,
+/// converting all eight Unicode line endings to the given target (as for the
+/// line_end_transform view). Returns the final position of out.
+template <typename Range, typename OutIter,
+          CONCEPT_REQUIRES_(rng::InputRange<Range>())>
+OutIter transform_line_ends(Range&& range, OutIter out,
+                            line_end target = line_end::lf)
+{
+    using char_type = rng::range_value_t<Range>;
+
+    line_end_transformer<char_type> transformer{target};
+    auto&& r = detail::view_all(std::forward<Range>(range));
+    out = transformer.transform(rng::begin(r), rng::end(r), std::move(out));
+    return transformer.flush(std::move(out));
+}
+
+} // end namespace utf_ranges
+} // end namespace tcb
+
+#endif // TCB_UTF_RANGES_LINE_END_HPP_INCLUDED
@@ -0,0 +1,186 @@
+// Copyright (c) 2016 Tristan Brindle (tcbrindle at gmail dot com)
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef TCB_UTF_RANGES_LINE_INDEX_HPP_INCLUDED
+#define TCB_UTF_RANGES_LINE_INDEX_HPP_INCLUDED
+
+#include <tcb/utf_ranges/detail/contiguous.hpp>
+#include <tcb/utf_ranges/detail/line_end.hpp>
+#include <tcb/utf_ranges/position_map.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace tcb {
+namespace utf_ranges {
+
+/// A position in text as a line and column, both counting from zero
+struct text_position {
+    std::size_t line = 0;
+    std::size_t column = 0;
+};
+
+inline bool operator==(const text_position& lhs, const text_position& rhs)
+{
+    return lhs.line == rhs.line && lhs.column == rhs.column;
+}
+
+inline bool operator!=(const text_position& lhs, const text_position& rhs)
+{
+    return !(lhs == rhs);
+}
+
+/// An index of the lines of a buffer of UTF-8 (or UTF-16) text, for
+/// converting between offsets and (line, column) positions in O(log n)
+/// time, rather than rescanning the text each time.
+///
+/// Lines are ended by any of the eight Unicode line terminators, as for
+/// view::lines and line_end_transform, and are found with the same block
+/// at a time scan, which is all that building the index costs. Columns may
+/// be counted in UTF-8 code units, UTF-16 code units or code points. The
+/// first lookup with columns in anything other than the buffer's own code
+/// units builds a basic_position_map of the text, which means another pass
+/// over it, a code point at a time. The map is built only once, even when
+/// that first lookup is made from several threads at the same time, and is
+/// shared with all copies of the index, whether they were made before or
+/// after it was built.
+///
+/// The index refers to the buffer, which must outlive it and must not be
+/// modified; build a new index if it is.
+template <typename CharT>
+class basic_line_index {
+public:
+    using char_type = CharT;
+
+    /// The unit in which offsets into the buffer are given
+    static constexpr position_unit native_unit = basic_position_map<CharT>::native_unit;
+
+    basic_line_index() = default;
+
+    basic_line_index(const CharT* first, const CharT* last)
+            : first_(first),
+              size_(static_cast<std::size_t>(last - first))
+    {
+        scan(first, last);
+    }
+
+    template <typename Range,
+              CONCEPT_REQUIRES_(detail::has_contiguous_data<const Range>())>
+    explicit basic_line_index(const Range& text)
+            : basic_line_index(detail::contiguous_data(text),
+                               detail::contiguous_data(text) + detail::contiguous_size(text))
+    {}
+
+    /// The number of lines. Unlike view::lines, text which ends with a line
+    /// terminator has an empty line after it (where an editor would put the
+    /// cursor), and empty text has one line.
+    std::size_t num_lines() const { return starts_.size(); }
+
+    /// The offset of the first code unit of line
+    std::size_t line_start(std::size_t line) const
+    {
+        return line < starts_.size() ? starts_[line] : size_;
+    }
+
+    /// The offset just past the end of line, not including its terminator
+    std::size_t line_end(std::size_t line) const
+    {
+        if (line >= starts_.size()) {
+            return size_;
+        }
+        return line + 1 < starts_.size() ? starts_[line + 1] - terminator_sizes_[line] : size_;
+    }
+
+    /// Returns the line and column of offset, counting the column in
+    /// column_unit. Offsets past the end give the end of the last line.
+    text_position position_of(std::size_t offset,
+                              position_unit column_unit = native_unit) const
+    {
+        offset = std::min(offset, size_);
+        const auto it = std::upper_bound(starts_.begin(), starts_.end(), offset) - 1;
+        text_position pos;
+        pos.line = static_cast<std::size_t>(it - starts_.begin());
+        pos.column = column_unit == native_unit
+                     ? offset - *it
+                     : column_map().convert(offset, native_unit, column_unit) -
+                       column_map().convert(*it, native_unit, column_unit);
+        return pos;
+    }
+
+    /// Returns the offset of pos, whose column is counted in column_unit.
+    /// A column past the end of the line gives the end of the line (before
+    /// its terminator), and a line past the end gives the end of the text.
+    std::size_t offset_of(text_position pos, position_unit column_unit = native_unit) const
+    {
+        if (pos.line >= starts_.size()) {
+            return size_;
+        }
+        const std::size_t start = starts_[pos.line];
+        const std::size_t end = line_end(pos.line);
+        if (column_unit == native_unit) {
+            return std::min(start + std::min(pos.column, size_), end);
+        }
+        const auto& map = column_map();
+        const std::size_t base = map.convert(start, native_unit, column_unit);
+        return std::min(map.convert(base + pos.column, column_unit, native_unit), end);
+    }
+
+private:
+    // Shared between copies, so that whichever of them looks up a column
+    // first builds the map for all of them
+    struct column_state {
+        std::once_flag once;
+        std::unique_ptr<const basic_position_map<CharT>> map;
+    };
+
+    const basic_position_map<CharT>& column_map() const
+    {
+        column_state& columns = *columns_;
+        std::call_once(columns.once, [this, &columns] {
+            columns.map = std::make_unique<const basic_position_map<CharT>>(first_,
+                                                                            first_ + size_);
+        });
+        return *columns.map;
+    }
+
+    void scan(const CharT* first, const CharT* last)
+    {
+        const CharT* p = first;
+        while (p != last) {
+            p = detail::find_line_end_candidate(p, last, true);
+            if (p == last) {
+                break;
+            }
+            const CharT* q = p;
+            if (detail::match_line_end(q, last) == line_terminator::none) {
+                ++p;
+                continue;
+            }
+            terminator_sizes_.push_back(static_cast<std::uint8_t>(q - p));
+            starts_.push_back(static_cast<std::size_t>(q - first));
+            p = q;
+        }
+    }
+
+    const CharT* first_ = nullptr;
+    std::size_t size_ = 0;
+    std::vector<std::size_t> starts_{0};
+    std::vector<std::uint8_t> terminator_sizes_;
+    std::shared_ptr<column_state> columns_ = std::make_shared<column_state>();
+};
+
+template <typename CharT>
+constexpr position_unit basic_line_index<CharT>::native_unit;
+
+using line_index = basic_line_index<char>;
+using u16_line_index = basic_line_index<char16_t>;
+
+} // end namespace utf_ranges
+} // end namespace tcb
+
+#endif // TCB_UTF_RANGES_LINE_INDEX_HPP_INCLUDED
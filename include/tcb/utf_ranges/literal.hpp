@@ -0,0 +1,168 @@
+// Copyright (c) 2016 Tristan Brindle (tcbrindle at gmail dot com)
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef TCB_UTF_RANGES_LITERAL_HPP_INCLUDED
+#define TCB_UTF_RANGES_LITERAL_HPP_INCLUDED
+
+#include <tcb/utf_ranges/detail/utf.hpp>
+
+#include <cstddef>
+#include <string>
+
+namespace tcb {
+namespace utf_ranges {
+
+/// A null-terminated string with a fixed capacity, which (unlike
+/// std::basic_string) can be created and examined in constant expressions.
+/// This is what literal() returns.
+template <typename CharT, std::size_t Capacity>
+class basic_fixed_string {
+public:
+    using value_type = CharT;
+    using size_type = std::size_t;
+    using const_iterator = const CharT*;
+    using iterator = const_iterator;
+
+    constexpr basic_fixed_string() = default;
+
+    /// Converts the string literal str (without its null terminator) to
+    /// this string's encoding, replacing any invalid sequences with U+FFFD.
+    /// Capacity must be large enough for the result.
+    template <typename InCharT, std::size_t N>
+    explicit constexpr basic_fixed_string(const InCharT (&str)[N])
+    {
+        const InCharT* first = str;
+        const InCharT* const last = str + (N - 1);
+        CharT* out = chars_;
+        while (first != last) {
+            const detail::code_point c = detail::decode_or_replace<InCharT>(first, last);
+            out = detail::utf_traits<CharT>::encode(c, out);
+        }
+        size_ = static_cast<std::size_t>(out - chars_);
+    }
+
+    constexpr const CharT* data() const noexcept { return chars_; }
+    constexpr const CharT* c_str() const noexcept { return chars_; }
+
+    constexpr std::size_t size() const noexcept { return size_; }
+    constexpr bool empty() const noexcept { return size_ == 0; }
+    static constexpr std::size_t capacity() noexcept { return Capacity; }
+
+    constexpr const_iterator begin() const noexcept { return chars_; }
+    constexpr const_iterator end() const noexcept { return chars_ + size_; }
+
+    constexpr CharT operator[](std::size_t i) const noexcept { return chars_[i]; }
+
+    std::basic_string<CharT> str() const { return {chars_, size_}; }
+
+private:
+    CharT chars_[Capacity + 1] = {};
+    std::size_t size_ = 0;
+};
+
+template <typename CharT, std::size_t N, std::size_t M>
+constexpr bool operator==(const basic_fixed_string<CharT, N>& lhs,
+                          const basic_fixed_string<CharT, M>& rhs) noexcept
+{
+    if (lhs.size() != rhs.size()) {
+        return false;
+    }
+    for (std::size_t i = 0; i < lhs.size(); i++) {
+        if (lhs[i] != rhs[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+template <typename CharT, std::size_t N, std::size_t M>
+constexpr bool operator!=(const basic_fixed_string<CharT, N>& lhs,
+                          const basic_fixed_string<CharT, M>& rhs) noexcept
+{
+    return !(lhs == rhs);
+}
+
+/// Compares with a string literal of the same encoding, ignoring its null
+/// terminator
+template <typename CharT, std::size_t N, std::size_t M>
+constexpr bool operator==(const basic_fixed_string<CharT, N>& lhs,
+                          const CharT (&rhs)[M]) noexcept
+{
+    if (lhs.size() != M - 1) {
+        return false;
+    }
+    for (std::size_t i = 0; i < lhs.size(); i++) {
+        if (lhs[i] != rhs[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+template <typename CharT, std::size_t N, std::size_t M>
+constexpr bool operator!=(const basic_fixed_string<CharT, N>& lhs,
+                          const CharT (&rhs)[M]) noexcept
+{
+    return !(lhs == rhs);
+}
+
+namespace detail {
+
+// The most code units of OutCharT that one code unit of InCharT can turn
+// into. Every sequence (or invalid unit, which becomes U+FFFD) gives a
+// single code point, so this is only more than one when going to a
+// narrower encoding: one UTF-32 unit can need four UTF-8 or two UTF-16
+// units, and one UTF-16 unit (or invalid UTF-8 byte) three UTF-8 units.
+template <typename InCharT, typename OutCharT>
+constexpr std::size_t max_expansion()
+{
+    return sizeof(OutCharT) == 4 ? 1 :
+           sizeof(OutCharT) == 2 ? (sizeof(InCharT) == 4 ? 2 : 1) :
+           (sizeof(InCharT) == 4 ? 4 : 3);
+}
+
+} // end namespace detail
+
+/// Returns the number of code units of OutCharT which the string literal
+/// str (without its null terminator) converts to. In a constant expression,
+/// this gives the exact capacity for a basic_fixed_string, as below.
+template <typename OutCharT, typename InCharT, std::size_t N>
+constexpr std::size_t converted_length(const InCharT (&str)[N])
+{
+    const InCharT* first = str;
+    const InCharT* const last = str + (N - 1);
+    std::size_t n = 0;
+    while (first != last) {
+        const detail::code_point c = detail::decode_or_replace<InCharT>(first, last);
+        n += static_cast<std::size_t>(detail::utf_traits<OutCharT>::width(c));
+    }
+    return n;
+}
+
+/// Converts a string literal to the encoding of OutCharT at compile time
+/// (when used in a constant expression), for example
+///
+///     constexpr auto greeting = literal<char16_t>(u8"Grüß Gott");
+///
+/// The result is a basic_fixed_string, whose capacity is the most the
+/// conversion could possibly need; size() gives the actual length. The
+/// capacity can't depend on the contents of str, since a function argument
+/// is never a constant expression, so it may be several times too large:
+/// ASCII text converted from UTF-8 to UTF-32 takes four times the space it
+/// needs. Where that matters, give the exact capacity yourself:
+///
+///     constexpr basic_fixed_string<char32_t, converted_length<char32_t>(u8"abc")>
+///             abc{u8"abc"};
+template <typename OutCharT, typename InCharT, std::size_t N>
+constexpr basic_fixed_string<OutCharT, (N - 1) * detail::max_expansion<InCharT, OutCharT>()>
+literal(const InCharT (&str)[N])
+{
+    return basic_fixed_string<OutCharT,
+                              (N - 1) * detail::max_expansion<InCharT, OutCharT>()>(str);
+}
+
+} // end namespace utf_ranges
+} // end namespace tcb
+
+#endif // TCB_UTF_RANGES_LITERAL_HPP_INCLUDED
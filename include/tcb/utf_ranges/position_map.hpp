@@ -0,0 +1,296 @@
+// Copyright (c) 2016 Tristan Brindle (tcbrindle at gmail dot com)
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef TCB_UTF_RANGES_POSITION_MAP_HPP_INCLUDED
+#define TCB_UTF_RANGES_POSITION_MAP_HPP_INCLUDED
+
+#include <tcb/utf_ranges/detail/code_points.hpp>
+#include <tcb/utf_ranges/detail/contiguous.hpp>
+
+#include <array>
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+namespace tcb {
+namespace utf_ranges {
+
+/// The units in which a position in text can be given
+enum class position_unit {
+    utf8,      ///< UTF-8 code units (bytes)
+    utf16,     ///< UTF-16 code units, as used by the Language Server Protocol
+    code_point ///< Code points
+};
+
+namespace detail {
+
+// The length of some text in each position_unit
+struct text_extent {
+    std::array<std::size_t, 3> n{{0, 0, 0}};
+
+    std::size_t operator[](position_unit u) const { return n[static_cast<int>(u)]; }
+
+    text_extent& operator+=(const text_extent& other)
+    {
+        for (std::size_t i = 0; i < n.size(); i++) {
+            n[i] += other.n[i];
+        }
+        return *this;
+    }
+
+    text_extent& operator-=(const text_extent& other)
+    {
+        for (std::size_t i = 0; i < n.size(); i++) {
+            n[i] -= other.n[i];
+        }
+        return *this;
+    }
+};
+
+// The extent of the single code point [p, q) of UTF-8 or UTF-16 text. Code
+// points are delimited as for count_code_points(), and the other encoding's
+// length is worked out from the lead unit alone, so it is exact for valid
+// UTF.
+template <typename CharT>
+text_extent code_point_extent(const CharT* p, const CharT* q)
+{
+    const auto lead = static_cast<std::make_unsigned_t<CharT>>(*p);
+    const auto units = static_cast<std::size_t>(q - p);
+    text_extent e;
+    e.n[static_cast<int>(position_unit::code_point)] = 1;
+    if (sizeof(CharT) == 1) {
+        e.n[static_cast<int>(position_unit::utf8)] = units;
+        e.n[static_cast<int>(position_unit::utf16)] = lead >= 0xF0 ? 2 : 1;
+    } else {
+        e.n[static_cast<int>(position_unit::utf16)] = units;
+        e.n[static_cast<int>(position_unit::utf8)] =
+                lead < 0x80 ? 1 : lead < 0x800 ? 2 : (lead & 0xFC00) == 0xD800 ? 4 : 3;
+    }
+    return e;
+}
+
+template <typename CharT>
+const CharT* next_code_point(const CharT* p, const CharT* last)
+{
+    while (++p != last && is_trail_unit(*p)) {}
+    return p;
+}
+
+} // end namespace detail
+
+/// Maps positions in a buffer of UTF-8 (or UTF-16) text between UTF-8 code
+/// units, UTF-16 code units and code points, in either direction. This is
+/// what a language server needs to do to every position it is given or
+/// sends, since LSP counts in UTF-16 units.
+///
+/// The text is divided into blocks of around block_size code units, and
+/// the length of each block in each unit is kept in a Fenwick tree. A
+/// lookup finds the right block in O(log blocks) time, and then walks
+/// through that block alone. When the text is edited, update() re-examines
+/// only the blocks which the edit touched.
+///
+/// The map refers to the buffer, which must not move or change except as
+/// reported to update(). Lengths are exact for valid UTF; in invalid text,
+/// code points are delimited as for count_code_points(). A position in
+/// the middle of a code point maps to the start of that code point.
+template <typename CharT>
+class basic_position_map {
+    static_assert(sizeof(CharT) == 1 || sizeof(CharT) == 2,
+                  "basic_position_map requires UTF-8 or UTF-16 text");
+
+public:
+    using char_type = CharT;
+
+    static constexpr std::size_t default_block_size = 1024;
+
+    /// The unit in which the buffer itself is measured
+    static constexpr position_unit native_unit =
+            sizeof(CharT) == 1 ? position_unit::utf8 : position_unit::utf16;
+
+    basic_position_map() = default;
+
+    basic_position_map(const CharT* first, const CharT* last,
+                       std::size_t block_size = default_block_size)
+            : first_(first),
+              block_size_(block_size > 0 ? block_size : 1)
+    {
+        scan(first, last, blocks_);
+        rebuild_tree();
+    }
+
+    template <typename Range,
+              CONCEPT_REQUIRES_(detail::has_contiguous_data<const Range>())>
+    explicit basic_position_map(const Range& text,
+                                std::size_t block_size = default_block_size)
+            : basic_position_map(detail::contiguous_data(text),
+                                 detail::contiguous_data(text) + detail::contiguous_size(text),
+                                 block_size)
+    {}
+
+    /// The length of the whole text, in the given unit
+    std::size_t size(position_unit unit) const { return total_[unit]; }
+
+    /// Converts offset, in units of from, to the corresponding offset in
+    /// units of to. Offsets past the end map to the end.
+    std::size_t convert(std::size_t offset, position_unit from, position_unit to) const
+    {
+        detail::text_extent before;
+        const std::size_t b = find_block(offset, from, before);
+        if (b == blocks_.size()) {
+            return total_[to];
+        }
+
+        const CharT* p = first_ + before[native_unit];
+        const CharT* const last = p + blocks_[b][native_unit];
+        while (p != last) {
+            const CharT* const q = detail::next_code_point(p, last);
+            const detail::text_extent e = detail::code_point_extent(p, q);
+            if (before[from] + e[from] > offset) {
+                break;
+            }
+            before += e;
+            p = q;
+        }
+        return before[to];
+    }
+
+    /// Tells the map that the removed code units of the text starting at
+    /// offset have been replaced with some others, giving the text
+    /// [first, last) (which may have moved). The edit must replace whole
+    /// code points, as any edit to valid text does.
+    void update(const CharT* first, const CharT* last, std::size_t offset, std::size_t removed)
+    {
+        const std::size_t old_size = total_[native_unit];
+        const std::size_t new_size = static_cast<std::size_t>(last - first);
+        first_ = first;
+
+        // The blocks from b0 up to (but not including) b1 cover the edit
+        detail::text_extent start;
+        std::size_t b0 = find_block(offset, native_unit, start);
+        if (b0 == blocks_.size() && b0 > 0) {
+            // Appending: extend the last block
+            --b0;
+            start -= blocks_[b0];
+        }
+        std::size_t b1 = b0;
+        std::size_t old_end = start[native_unit];
+        while (b1 < blocks_.size() && (b1 == b0 || old_end < offset + removed)) {
+            old_end += blocks_[b1++][native_unit];
+        }
+
+        const std::size_t new_end = old_end + new_size - old_size;
+        std::vector<detail::text_extent> replacement;
+        scan(first + start[native_unit], first + new_end, replacement);
+
+        if (replacement.size() == b1 - b0) {
+            for (std::size_t i = 0; i < replacement.size(); i++) {
+                detail::text_extent delta = replacement[i];
+                delta -= blocks_[b0 + i];
+                tree_add(b0 + i, delta);
+                blocks_[b0 + i] = replacement[i];
+            }
+        } else {
+            blocks_.erase(blocks_.begin() + static_cast<std::ptrdiff_t>(b0),
+                          blocks_.begin() + static_cast<std::ptrdiff_t>(b1));
+            blocks_.insert(blocks_.begin() + static_cast<std::ptrdiff_t>(b0),
+                           replacement.begin(), replacement.end());
+            rebuild_tree();
+        }
+    }
+
+    template <typename Range,
+              CONCEPT_REQUIRES_(detail::has_contiguous_data<const Range>())>
+    void update(const Range& text, std::size_t offset, std::size_t removed)
+    {
+        const CharT* const first = detail::contiguous_data(text);
+        update(first, first + detail::contiguous_size(text), offset, removed);
+    }
+
+private:
+    // Splits [p, last) into blocks of at least block_size_ code units
+    // (except perhaps the last), ending on code point boundaries
+    void scan(const CharT* p, const CharT* last, std::vector<detail::text_extent>& out) const
+    {
+        detail::text_extent block;
+        while (p != last) {
+            const CharT* const q = detail::next_code_point(p, last);
+            block += detail::code_point_extent(p, q);
+            p = q;
+            if (block[native_unit] >= block_size_) {
+                out.push_back(block);
+                block = detail::text_extent{};
+            }
+        }
+        if (block[native_unit] != 0) {
+            out.push_back(block);
+        }
+    }
+
+    // The Fenwick tree: tree_[i] (counting from one) holds the total extent
+    // of the blocks (i - (i & -i), i]
+    void rebuild_tree()
+    {
+        tree_.assign(blocks_.size() + 1, detail::text_extent{});
+        total_ = detail::text_extent{};
+        for (std::size_t i = 1; i <= blocks_.size(); i++) {
+            tree_[i] += blocks_[i - 1];
+            total_ += blocks_[i - 1];
+            const std::size_t parent = i + (i & (~i + 1));
+            if (parent < tree_.size()) {
+                tree_[parent] += tree_[i];
+            }
+        }
+    }
+
+    // A delta may be "negative": unsigned arithmetic wraps around, so
+    // adding it still gives the right answer
+    void tree_add(std::size_t block, const detail::text_extent& delta)
+    {
+        for (std::size_t i = block + 1; i < tree_.size(); i += i & (~i + 1)) {
+            tree_[i] += delta;
+        }
+        total_ += delta;
+    }
+
+    // Returns the block containing offset (in units of unit), or the
+    // number of blocks if it is past the end, and sets before to the
+    // extent of the blocks before it
+    std::size_t find_block(std::size_t offset, position_unit unit,
+                           detail::text_extent& before) const
+    {
+        before = detail::text_extent{};
+        std::size_t pos = 0;
+        std::size_t step = 1;
+        while (step * 2 < tree_.size()) {
+            step *= 2;
+        }
+        for (; step > 0; step /= 2) {
+            if (pos + step < tree_.size() && before[unit] + tree_[pos + step][unit] <= offset) {
+                pos += step;
+                before += tree_[pos];
+            }
+        }
+        return pos;
+    }
+
+    const CharT* first_ = nullptr;
+    std::size_t block_size_ = default_block_size;
+    std::vector<detail::text_extent> blocks_;
+    std::vector<detail::text_extent> tree_;
+    detail::text_extent total_;
+};
+
+template <typename CharT>
+constexpr std::size_t basic_position_map<CharT>::default_block_size;
+
+template <typename CharT>
+constexpr position_unit basic_position_map<CharT>::native_unit;
+
+using position_map = basic_position_map<char>;
+using u16_position_map = basic_position_map<char16_t>;
+
+} // end namespace utf_ranges
+} // end namespace tcb
+
+#endif // TCB_UTF_RANGES_POSITION_MAP_HPP_INCLUDED
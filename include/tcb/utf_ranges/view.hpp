@@ -9,7 +9,9 @@
 #include <tcb/utf_ranges/view/bom.hpp>
 #include <tcb/utf_ranges/view/bytes.hpp>
 #include <tcb/utf_ranges/view/endian_convert.hpp>
+#include <tcb/utf_ranges/view/from_bytes.hpp>
 #include <tcb/utf_ranges/view/line_end_transform.hpp>
+#include <tcb/utf_ranges/view/lines.hpp>
 #include <tcb/utf_ranges/view/utf_convert.hpp>
 
 #endif // TCB_UTF_RANGES_VIEW_HPP_INCLUDED
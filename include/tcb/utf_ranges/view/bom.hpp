@@ -7,15 +7,17 @@
 #define TCB_UTF_RANGES_VIEW_BOM_HPP_INCLUDED
 
 #include <tcb/utf_ranges/view/endian_convert.hpp>
+#include <tcb/utf_ranges/view/from_bytes.hpp>
 #include <tcb/utf_ranges/view/utf_convert.hpp>
 
-#include <range/v3/algorithm/copy_n.hpp>
 #include <range/v3/algorithm/equal.hpp>
+#include <range/v3/view_facade.hpp>
 #include <range/v3/view_interface.hpp>
-#include <range/v3/view/concat.hpp>
+#include <range/v3/view/all.hpp>
 #include <range/v3/view/drop.hpp>
-#include <range/v3/view/single.hpp>
-#include <range/v3/view/take.hpp>
+
+#include <array>
+#include <cstdint>
 
 namespace tcb {
 namespace utf_ranges {
@@ -74,6 +76,10 @@ bool has_swapped_bom(const Range& range)
 {
     using v = rng::range_value_t<Range>;
 
+    if (rng::empty(range)) {
+        return false;
+    }
+
     switch (sizeof(v)) {
     case 2:
         return static_cast<std::uint16_t>(*rng::begin(range)) ==
@@ -86,63 +92,217 @@ bool has_swapped_bom(const Range& range)
     }
 }
 
+// Removes the first n elements of the range; contiguous ranges stay that way
+template <typename Range,
+          CONCEPT_REQUIRES_(utf_ranges::detail::is_contiguous_range<Range>())>
+auto drop_bom(Range&& range, std::size_t n)
+{
+    const auto first = utf_ranges::detail::contiguous_data(range);
+    const auto last = first + utf_ranges::detail::contiguous_size(range);
+    return rng::iterator_range<std::decay_t<decltype(first)>>(first + n, last);
+}
+
+template <typename Range,
+          CONCEPT_REQUIRES_(!utf_ranges::detail::is_contiguous_range<Range>())>
+auto drop_bom(Range&& range, std::size_t n)
+{
+    return rng::view::drop(std::forward<Range>(range),
+                           static_cast<rng::range_difference_t<Range>>(n));
+}
+
+// Fixed-size inline storage for a BOM (or for the code units we had to read
+// from an InputRange to find out that there wasn't one). A BOM is at most
+// three code units long, so there's no need to go to the heap.
+template <typename CharT>
+class bom_prefix {
+public:
+    static constexpr std::size_t max_size = 3;
+
+    constexpr bom_prefix() = default;
+
+    void push_back(CharT c) { chars_[size_++] = c; }
+
+    void clear() { size_ = 0; }
+
+    constexpr std::size_t size() const { return size_; }
+
+    constexpr CharT operator[](std::size_t i) const { return chars_[i]; }
+
+    const CharT* begin() const { return chars_.data(); }
+
+    const CharT* end() const { return chars_.data() + size_; }
+
+private:
+    std::array<CharT, max_size> chars_{{}};
+    std::uint8_t size_ = 0;
+};
+
+template <typename CharT>
+bom_prefix<CharT> make_bom()
+{
+    const auto encoded = utf_ranges::detail::utf_traits<CharT>::encode(U'\uFEFF');
+    bom_prefix<CharT> bom;
+    for (int i = 0; i < encoded.size(); i++) {
+        bom.push_back(encoded[i]);
+    }
+    return bom;
+}
+
+// View which yields the (at most three) code units of a prefix, followed by
+// the elements of the underlying range. Each cursor carries its own copy of
+// the prefix and a count of how much of it remains. Reading element by
+// element still tests that count for every element; fused_copy() avoids
+// this by taking the prefix and base() as two separate phases.
+//
+// The view has the same category as the underlying range (up to random
+// access), as view::concat did.
 template <typename Rng>
-struct bom_concat_view : rng::view_adaptor<bom_concat_view<Rng>, Rng>
+class bom_prefix_view
+        : public rng::view_facade<bom_prefix_view<Rng>, rng::unknown>
 {
 private:
-    using string_type = std::basic_string<rng::range_value_t<Rng>>;
+    friend rng::range_access;
+
+    using value_type = rng::range_value_t<Rng>;
+    using prefix_type = bom_prefix<value_type>;
 
-    struct adaptor : rng::adaptor_base {
+    template <bool Const>
+    struct cursor {
+        using base_t = std::conditional_t<Const, const Rng, Rng>;
+        using view_t = std::conditional_t<Const, const bom_prefix_view, bom_prefix_view>;
+        using difference_type = rng::range_difference_t<base_t>;
 
-        adaptor() = default;
+        cursor() = default;
 
-        adaptor(bom_concat_view& view)
-                : bom_first_(view.bom_.begin()),
-                  bom_last_(view.bom_.end())
+        cursor(view_t& view)
+                : begin_(rng::begin(view.base_)),
+                  first_(begin_),
+                  last_(rng::end(view.base_)),
+                  prefix_(view.prefix_),
+                  remaining_(static_cast<std::uint8_t>(view.prefix_.size()))
         {}
 
-        auto get(rng::range_iterator_t<Rng> it) const
+        value_type get() const
         {
-            if (bom_first_ != bom_last_) {
-                return *bom_first_;
+            if (remaining_ != 0) {
+                return prefix_[prefix_.size() - remaining_];
+            }
+            return *first_;
+        }
+
+        void next()
+        {
+            if (remaining_ != 0) {
+                --remaining_;
             } else {
-                return *it;
+                ++first_;
             }
         }
 
-        void next(rng::range_iterator_t<Rng>& it)
+        bool done() const
+        {
+            return remaining_ == 0 && first_ == last_;
+        }
+
+        CONCEPT_REQUIRES(rng::ForwardRange<base_t>())
+        bool equal(const cursor& other) const
         {
-            if (bom_first_ != bom_last_) {
-                ++bom_first_;
+            return remaining_ == other.remaining_ && first_ == other.first_;
+        }
+
+        CONCEPT_REQUIRES(rng::BidirectionalRange<base_t>())
+        void prev()
+        {
+            if (first_ == begin_) {
+                ++remaining_;
             } else {
-                ++it;
+                --first_;
             }
         }
 
-        rng::range_iterator_t<string_type> bom_first_{};
-        rng::range_sentinel_t<string_type> bom_last_{};
+        CONCEPT_REQUIRES(rng::RandomAccessRange<base_t>())
+        void advance(difference_type n)
+        {
+            const difference_type pos = position() + n;
+            if (pos < 0) {
+                first_ = begin_;
+                remaining_ = static_cast<std::uint8_t>(-pos);
+            } else {
+                first_ = begin_ + pos;
+                remaining_ = 0;
+            }
+        }
+
+        CONCEPT_REQUIRES(rng::RandomAccessRange<base_t>())
+        difference_type distance_to(const cursor& other) const
+        {
+            return other.position() - position();
+        }
+
+        // The offset from the start of the underlying range, so that the
+        // prefix is at negative positions
+        difference_type position() const
+        {
+            return (first_ - begin_) - remaining_;
+        }
+
+        rng::range_iterator_t<base_t> begin_{};
+        rng::range_iterator_t<base_t> first_{};
+        rng::range_sentinel_t<base_t> last_{};
+        prefix_type prefix_{};
+        std::uint8_t remaining_ = 0;
     };
 
+    cursor<false> begin_cursor() { return cursor<false>{*this}; }
+
+    CONCEPT_REQUIRES(rng::Range<const Rng>())
+    cursor<true> begin_cursor() const { return cursor<true>{*this}; }
 
 public:
-    bom_concat_view() = default;
+    bom_prefix_view() = default;
 
-    bom_concat_view(Rng rng, string_type bom)
-            : rng::view_adaptor<bom_concat_view, Rng>(std::move(rng)),
-              bom_(std::move(bom))
+    bom_prefix_view(Rng range, prefix_type prefix)
+            : base_(std::move(range)),
+              prefix_(prefix)
     {}
 
-    adaptor begin_adaptor() { return adaptor{*this}; }
+    CONCEPT_REQUIRES(rng::SizedRange<const Rng>())
+    std::size_t size() const
+    {
+        return rng::size(base_) + prefix_.size();
+    }
+
+    Rng base() const { return base_; }
+
+    const prefix_type& prefix() const { return prefix_; }
 
 private:
-    string_type bom_;
+    Rng base_{};
+    prefix_type prefix_{};
 };
 
+template <typename T>
+struct is_bom_prefix_view : std::false_type {};
+
+template <typename Rng>
+struct is_bom_prefix_view<bom_prefix_view<Rng>> : std::true_type {};
+
 } // end namespace detail
 
 struct consume_bom_fn {
+    // For byte streams being reassembled into code units, we can avoid
+    // stacking an endian_convert on top: the from_bytes view detects the BOM
+    // itself and simply reassembles in the opposite byte order if necessary
     template <typename Range,
-              CONCEPT_REQUIRES_(rng::ForwardRange<Range>())>
+              CONCEPT_REQUIRES_(utf_ranges::detail::is_from_bytes_view<std::decay_t<Range>>())>
+    auto operator()(Range&& range) const
+    {
+        return range.with_bom_detection();
+    }
+
+    template <typename Range,
+              CONCEPT_REQUIRES_(rng::ForwardRange<Range>() &&
+                                !utf_ranges::detail::is_from_bytes_view<std::decay_t<Range>>())>
     auto operator()(Range&& range) const
     {
         using value_type = rng::range_value_t<Range>;
@@ -163,7 +323,8 @@ struct consume_bom_fn {
 
     template <typename Range,
               CONCEPT_REQUIRES_(rng::InputRange<Range>() &&
-                                !rng::ForwardRange<Range>())>
+                                !rng::ForwardRange<Range>() &&
+                                !utf_ranges::detail::is_from_bytes_view<std::decay_t<Range>>())>
     auto operator()(Range&& range) const
     {
         using value_type = rng::range_value_t<Range>;
@@ -172,10 +333,16 @@ struct consume_bom_fn {
         boost::endian::order byte_order = boost::endian::order::native;
 
         // For InputRanges (only), testing for the BOM will "eat up" the first
-        // character(s) of the range. So save them in a temporary string so that
+        // character(s) of the range. So save them in a small buffer so that
         // we can put them back later if it turns out not to be a BOM.
-        std::basic_string<value_type> buf{};
-        rng::copy_n(rng::begin(range), bom_size, rng::back_inserter(buf));
+        detail::bom_prefix<value_type> buf{};
+        auto it = rng::begin(range);
+        const auto last = rng::end(range);
+        while (static_cast<rng::range_difference_t<Range>>(buf.size()) < bom_size &&
+               it != last) {
+            buf.push_back(*it);
+            ++it;
+        }
 
         if (detail::has_bom(buf)) {
             buf.clear();
@@ -185,12 +352,39 @@ struct consume_bom_fn {
         }
 
         return endian_convert<>(
-                detail::bom_concat_view<rng::view::all_t<Range>>(
-                        rng::view::all(std::forward<Range>(range)),
-                        std::move(buf)),
+                detail::bom_prefix_view<rng::view::all_t<Range>>(
+                        rng::view::all(std::forward<Range>(range)), buf),
                 byte_order);
     }
 
+    // Detects the BOM once, and then passes fn a view specialised for the
+    // byte order that was found: either the rest of the range as it is, or
+    // a view which unconditionally byte-swaps it. This saves checking the
+    // byte order again for every element. Both calls to fn must return the
+    // same type (or void).
+    template <typename Range, typename Fn,
+              CONCEPT_REQUIRES_(rng::ForwardRange<Range>())>
+    decltype(auto) operator()(Range&& range, Fn fn) const
+    {
+        using value_type = rng::range_value_t<Range>;
+        constexpr auto native = boost::endian::order::native;
+
+        if (detail::has_bom(range)) {
+            return fn(endian_convert<native, native>(
+                    detail::drop_bom(std::forward<Range>(range),
+                                     detail::bom_size_v<value_type>)));
+        }
+
+        if (detail::has_swapped_bom(range)) {
+            return fn(endian_convert<detail::nonnative_order, native>(
+                    detail::drop_bom(std::forward<Range>(range),
+                                     detail::bom_size_v<value_type>)));
+        }
+
+        return fn(endian_convert<native, native>(
+                detail::drop_bom(std::forward<Range>(range), 0)));
+    }
+
     decltype(auto) operator()() const {
         return rng::make_pipeable(std::bind(*this));
     }
@@ -204,10 +398,10 @@ struct add_bom_fn {
     auto operator()(Range&& range) const
     {
         using char_type = rng::range_value_t<Range>;
-        constexpr char32_t bom = U'\uFEFF';
 
-        return rng::view::concat(utf_convert<char_type>(rng::view::single(bom)),
-                                 std::forward<Range>(range));
+        return detail::bom_prefix_view<rng::view::all_t<Range>>(
+                rng::view::all(std::forward<Range>(range)),
+                detail::make_bom<char_type>());
     }
 
     decltype(auto) operator()() const
@@ -70,6 +70,16 @@ public:
     adaptor begin_adaptor() const { return adaptor{*this}; }
 };
 
+namespace detail {
+
+template <typename T>
+struct is_bytes_view : std::false_type {};
+
+template <typename Rng>
+struct is_bytes_view<bytes_view<Rng>> : std::true_type {};
+
+} // end namespace detail
+
 namespace view {
 
 struct bytes_fn {
@@ -6,9 +6,12 @@
 #ifndef TCB_UTF_RANGES_VIEW_ENDIAN_CONVERT_HPP_INCLUDED
 #define TCB_UTF_RANGES_VIEW_ENDIAN_CONVERT_HPP_INCLUDED
 
+#include <tcb/utf_ranges/detail/contiguous.hpp>
+
 #include <boost/endian/conversion.hpp>
 #include <range/v3/view_adaptor.hpp>
-#include <range/v3/view/transform.hpp>
+#include <range/v3/view/all.hpp>
+#include <range/v3/view/view.hpp>
 
 namespace tcb {
 namespace utf_ranges {
@@ -71,20 +74,167 @@ inline swap_wrapper<wchar_t> endian_reverse(swap_wrapper<wchar_t> s) noexcept
 
 } // end namespace detail
 
+/// View which converts each element of the underlying range from the given
+/// source byte order to DestOrder. The source order is only known at run
+/// time, so it is checked once when the view's iterators are created rather
+/// than for every element.
+template <typename Rng, boost::endian::order DestOrder>
+class endian_convert_view
+        : public rng::view_adaptor<endian_convert_view<Rng, DestOrder>, Rng>
+{
+private:
+    friend rng::range_access;
+
+    using value_type = rng::range_value_t<Rng>;
+
+    struct adaptor : rng::adaptor_base {
+        adaptor() = default;
+
+        adaptor(bool swap) : swap_(swap) {}
+
+        value_type get(rng::range_iterator_t<Rng> it) const
+        {
+            const value_type c = *it;
+            return swap_ ? detail::endian_reverse(detail::make_swap_wrapper(c)).value
+                         : c;
+        }
+
+        bool swap_ = false;
+    };
+
+    adaptor begin_adaptor() const { return adaptor{needs_swap()}; }
+
+    adaptor end_adaptor() const { return adaptor{needs_swap()}; }
+
+public:
+    endian_convert_view() = default;
+
+    endian_convert_view(Rng range,
+                        boost::endian::order src_order = boost::endian::order::native)
+            : rng::view_adaptor<endian_convert_view, Rng>(std::move(range)),
+              src_order_(src_order)
+    {}
+
+    static constexpr boost::endian::order dest_order = DestOrder;
+
+    boost::endian::order source_order() const { return src_order_; }
+
+    /// Returns true if elements need to be byte-swapped on their way through
+    bool needs_swap() const
+    {
+        return sizeof(value_type) > 1 && src_order_ != DestOrder;
+    }
+
+private:
+    boost::endian::order src_order_ = boost::endian::order::native;
+};
+
+/// View which unconditionally reverses the byte order of each element of the
+/// underlying range. This is what endian_convert<SrcOrder, DestOrder> gives
+/// you when the two orders differ.
+template <typename Rng>
+class byte_swap_view
+        : public rng::view_adaptor<byte_swap_view<Rng>, Rng>
+{
+private:
+    friend rng::range_access;
+
+    using value_type = rng::range_value_t<Rng>;
+
+    struct adaptor : rng::adaptor_base {
+        value_type get(rng::range_iterator_t<Rng> it) const
+        {
+            const value_type c = *it;
+            return detail::endian_reverse(detail::make_swap_wrapper(c)).value;
+        }
+    };
+
+    adaptor begin_adaptor() const { return {}; }
+
+    adaptor end_adaptor() const { return {}; }
+
+public:
+    byte_swap_view() = default;
+
+    byte_swap_view(Rng range)
+            : rng::view_adaptor<byte_swap_view, Rng>(std::move(range))
+    {}
+};
+
+namespace detail {
+
+template <typename T>
+struct is_endian_convert_view : std::false_type {};
+
+template <typename Rng, boost::endian::order DestOrder>
+struct is_endian_convert_view<endian_convert_view<Rng, DestOrder>>
+        : std::true_type {};
+
+template <typename T>
+struct is_byte_swap_view : std::false_type {};
+
+template <typename Rng>
+struct is_byte_swap_view<byte_swap_view<Rng>> : std::true_type {};
+
+template <typename T>
+struct is_any_endian_view
+        : std::integral_constant<bool, is_endian_convert_view<T>::value ||
+                                       is_byte_swap_view<T>::value> {};
+
+constexpr boost::endian::order opposite_order(boost::endian::order o)
+{
+    return o == boost::endian::order::big ? boost::endian::order::little
+                                          : boost::endian::order::big;
+}
+
+// The source order which makes an endian_convert_view<Rng, DestOrder> swap
+// bytes if (and only if) swap is true
+constexpr boost::endian::order source_order_for(bool swap, boost::endian::order dest)
+{
+    return swap ? opposite_order(dest) : dest;
+}
+
+template <typename View>
+using endian_base_t = std::decay_t<decltype(std::declval<View&>().base())>;
+
+} // end namespace detail
+
 namespace view {
 
 template <boost::endian::order DestOrder>
 struct endian_convert_fn {
-    template <typename Range>
-    auto operator()(Range&& range,
-                    boost::endian::order src_order = boost::endian::order::native) const
+    template <typename Range,
+              CONCEPT_REQUIRES_(!utf_ranges::detail::is_any_endian_view<std::decay_t<Range>>())>
+    endian_convert_view<utf_ranges::detail::view_all_t<Range>, DestOrder>
+    operator()(Range&& range,
+               boost::endian::order src_order = boost::endian::order::native) const
+    {
+        return {utf_ranges::detail::view_all(std::forward<Range>(range)), src_order};
+    }
+
+    // Converting the output of another endian conversion: two swaps cancel
+    // out, so make a single view over the original range which swaps only if
+    // exactly one of the two would have
+    template <typename Range,
+              typename View = std::decay_t<Range>,
+              CONCEPT_REQUIRES_(utf_ranges::detail::is_endian_convert_view<View>())>
+    endian_convert_view<utf_ranges::detail::endian_base_t<View>, DestOrder>
+    operator()(Range&& range,
+               boost::endian::order src_order = boost::endian::order::native) const
     {
-        const auto swapper = [src_order] (auto c){
-            return boost::endian::conditional_reverse(detail::make_swap_wrapper(c),
-                                                      src_order, DestOrder).value;
-        };
-        return rng::view::transform(std::forward<Range>(range),
-                                    std::move(swapper));
+        const bool swap = range.needs_swap() != (src_order != DestOrder);
+        return {range.base(), utf_ranges::detail::source_order_for(swap, DestOrder)};
+    }
+
+    template <typename Range,
+              typename View = std::decay_t<Range>,
+              CONCEPT_REQUIRES_(utf_ranges::detail::is_byte_swap_view<View>())>
+    endian_convert_view<utf_ranges::detail::endian_base_t<View>, DestOrder>
+    operator()(Range&& range,
+               boost::endian::order src_order = boost::endian::order::native) const
+    {
+        const bool swap = src_order == DestOrder;
+        return {range.base(), utf_ranges::detail::source_order_for(swap, DestOrder)};
     }
 
     decltype(auto) operator()(boost::endian::order src_endian = boost::endian::order::native) const
@@ -94,10 +244,87 @@ struct endian_convert_fn {
     }
 };
 
+// Both byte orders known at compile time: either there's nothing to do, in
+// which case we just hand back the original range (keeping it contiguous,
+// sized etc), or every element needs swapping, with no run-time check
+template <boost::endian::order SrcOrder, boost::endian::order DestOrder>
+struct static_endian_convert_fn {
+private:
+    template <typename Range>
+    static utf_ranges::detail::view_all_t<Range>
+    impl(Range&& range, std::false_type /*swap*/)
+    {
+        return utf_ranges::detail::view_all(std::forward<Range>(range));
+    }
+
+    template <typename Range,
+              CONCEPT_REQUIRES_(!utf_ranges::detail::is_any_endian_view<std::decay_t<Range>>())>
+    static byte_swap_view<utf_ranges::detail::view_all_t<Range>>
+    impl(Range&& range, std::true_type /*swap*/)
+    {
+        return {utf_ranges::detail::view_all(std::forward<Range>(range))};
+    }
+
+    // Swapping back something we've already swapped: just unwrap it
+    template <typename Range,
+              CONCEPT_REQUIRES_(utf_ranges::detail::is_byte_swap_view<std::decay_t<Range>>())>
+    static utf_ranges::detail::endian_base_t<std::decay_t<Range>>
+    impl(Range&& range, std::true_type /*swap*/)
+    {
+        return range.base();
+    }
+
+    // Swapping the output of a run-time endian conversion: reverse its
+    // decision instead
+    template <typename Range,
+              typename View = std::decay_t<Range>,
+              CONCEPT_REQUIRES_(utf_ranges::detail::is_endian_convert_view<View>())>
+    static View impl(Range&& range, std::true_type /*swap*/)
+    {
+        return {range.base(),
+                utf_ranges::detail::source_order_for(!range.needs_swap(),
+                                                     View::dest_order)};
+    }
+
+public:
+    template <typename Range,
+              typename Swap = std::integral_constant<bool,
+                      SrcOrder != DestOrder && (sizeof(rng::range_value_t<Range>) > 1)>>
+    auto operator()(Range&& range) const
+    {
+        return impl(std::forward<Range>(range), Swap{});
+    }
+
+    decltype(auto) operator()() const
+    {
+        return rng::make_pipeable(std::bind(*this));
+    }
+};
+
+// endian_convert<DestOrder> takes the source order as a run-time argument;
+// endian_convert<SrcOrder, DestOrder> fixes both at compile time
+template <boost::endian::order... Orders>
+struct endian_convert_selector {
+    static_assert(sizeof...(Orders) <= 2,
+                  "endian_convert takes at most two byte orders");
+};
+
+template <boost::endian::order DestOrder>
+struct endian_convert_selector<DestOrder> {
+    using type = endian_convert_fn<DestOrder>;
+};
+
+template <boost::endian::order SrcOrder, boost::endian::order DestOrder>
+struct endian_convert_selector<SrcOrder, DestOrder> {
+    using type = static_endian_convert_fn<SrcOrder, DestOrder>;
+};
+
 inline namespace
 {
-    template <boost::endian::order DestOrder = boost::endian::order::native>
-    constexpr auto& endian_convert = static_const<rng::view::view<endian_convert_fn<DestOrder>>>::value;
+    template <boost::endian::order First = boost::endian::order::native,
+              boost::endian::order... Rest>
+    constexpr auto& endian_convert = static_const<rng::view::view<
+            typename endian_convert_selector<First, Rest...>::type>>::value;
 }
 
 } // end namespace view
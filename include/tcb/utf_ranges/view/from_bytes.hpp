@@ -0,0 +1,427 @@
+// Copyright (c) 2016 Tristan Brindle (tcbrindle at gmail dot com)
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef TCB_UTF_RANGES_VIEW_FROM_BYTES_HPP_INCLUDED
+#define TCB_UTF_RANGES_VIEW_FROM_BYTES_HPP_INCLUDED
+
+#include <tcb/utf_ranges/detail/contiguous.hpp>
+
+#include <boost/endian/conversion.hpp>
+#include <range/v3/iterator_range.hpp>
+#include <range/v3/view_facade.hpp>
+#include <range/v3/view/all.hpp>
+#include <range/v3/view/view.hpp>
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+
+namespace tcb {
+namespace utf_ranges {
+
+namespace rng = ::ranges::v3;
+using rng::static_const;
+
+namespace detail {
+
+template <std::size_t> struct uint_of_size;
+template <> struct uint_of_size<1> { using type = std::uint8_t; };
+template <> struct uint_of_size<2> { using type = std::uint16_t; };
+template <> struct uint_of_size<4> { using type = std::uint32_t; };
+
+template <typename T>
+using uint_of_size_t = typename uint_of_size<sizeof(T)>::type;
+
+// Reassembles a single code unit from sizeof(CharT) bytes. The fixed-size
+// memcpy compiles down to a single (unaligned) load, and the swap to a single
+// bswap/rol, so this is as cheap as reading the unit directly.
+template <typename CharT>
+CharT load_code_unit(const unsigned char* p, bool swap) noexcept
+{
+    uint_of_size_t<CharT> u;
+    std::memcpy(&u, p, sizeof(u));
+    if (swap) {
+        u = boost::endian::endian_reverse(u);
+    }
+    return static_cast<CharT>(u);
+}
+
+// As above, for a byte order fixed at compile time
+template <typename CharT, bool Swap>
+CharT load_code_unit(const unsigned char* p, std::integral_constant<bool, Swap>) noexcept
+{
+    uint_of_size_t<CharT> u;
+    std::memcpy(&u, p, sizeof(u));
+    return static_cast<CharT>(Swap ? boost::endian::endian_reverse(u) : u);
+}
+
+// How a from_bytes_view decides whether to swap the bytes of each code unit:
+// at run time, from the requested byte order and any BOM, or fixed in the
+// type, so that reading a unit involves no test at all
+enum class swap_mode { dynamic, never, always };
+
+constexpr swap_mode fixed_swap_mode(boost::endian::order order)
+{
+    return order == boost::endian::order::native ? swap_mode::never : swap_mode::always;
+}
+
+// A cursor's swap flag: a bool, or for the fixed modes an empty
+// std::integral_constant, which selects the load_code_unit() overload above
+template <swap_mode Mode>
+using swap_flag_t = std::conditional_t<Mode == swap_mode::dynamic, bool,
+                                       std::integral_constant<bool, Mode == swap_mode::always>>;
+
+inline bool make_swap_flag(bool swap, bool) { return swap; }
+
+template <bool Swap>
+std::integral_constant<bool, Swap>
+make_swap_flag(bool, std::integral_constant<bool, Swap> flag) { return flag; }
+
+// Only reachable in dynamic mode, as fixed modes never consume a BOM
+inline void flip_swap_flag(bool& swap) { swap = !swap; }
+
+template <bool Swap>
+void flip_swap_flag(std::integral_constant<bool, Swap>&) {}
+
+template <typename CharT>
+constexpr uint_of_size_t<CharT> swapped_bom_value()
+{
+    return sizeof(CharT) == 2 ? 0xFFFEu : 0xFFFE0000u;
+}
+
+} // end namespace detail
+
+/// View which reassembles UTF-16 or UTF-32 code units from a range of bytes
+/// in the given byte order. Trailing bytes which do not make up a complete
+/// code unit are ignored.
+///
+/// When the byte source is contiguous (and has been reduced to a pair of
+/// pointers by view::from_bytes) the view is random-access and sized;
+/// otherwise the bytes are read one code unit at a time, which works with
+/// single-pass input ranges such as istreambuf_range.
+///
+/// With the default Mode, the byte order is chosen at run time, and may be
+/// changed by a BOM. view::from_bytes<CharT, Order> instead fixes it in the
+/// type, so that nothing is tested as each code unit is read.
+template <typename Rng, typename CharT,
+          detail::swap_mode Mode = detail::swap_mode::dynamic>
+class from_bytes_view
+        : public rng::view_facade<from_bytes_view<Rng, CharT, Mode>, rng::unknown>
+{
+    static_assert(sizeof(CharT) == 2 || sizeof(CharT) == 4,
+                  "from_bytes_view can only produce 16- or 32-bit code units");
+    static_assert(sizeof(rng::range_value_t<Rng>) == 1,
+                  "from_bytes_view requires a range of bytes");
+
+    friend rng::range_access;
+
+    using byte = unsigned char;
+    using swap_flag = detail::swap_flag_t<Mode>;
+
+    static constexpr bool is_contiguous =
+            std::is_pointer<rng::range_iterator_t<Rng>>::value;
+
+    // Used when the underlying bytes are in memory: one pointer bump per
+    // code unit, and full random access
+    struct contiguous_cursor {
+        contiguous_cursor() = default;
+
+        contiguous_cursor(const byte* p, bool swap)
+                : p_(p), swap_(detail::make_swap_flag(swap, swap_flag{}))
+        {}
+
+        CharT get() const
+        {
+            return detail::load_code_unit<CharT>(p_, swap_);
+        }
+
+        void next() { p_ += sizeof(CharT); }
+
+        void prev() { p_ -= sizeof(CharT); }
+
+        void advance(std::ptrdiff_t n) { p_ += n * std::ptrdiff_t{sizeof(CharT)}; }
+
+        std::ptrdiff_t distance_to(const contiguous_cursor& other) const
+        {
+            return (other.p_ - p_) / std::ptrdiff_t{sizeof(CharT)};
+        }
+
+        bool equal(const contiguous_cursor& other) const
+        {
+            return p_ == other.p_;
+        }
+
+        const byte* p_ = nullptr;
+        swap_flag swap_{};
+    };
+
+    // Used for everything else: reads ahead one code unit at a time
+    template <bool Const>
+    struct input_cursor {
+        using view_t = std::conditional_t<Const, const from_bytes_view, from_bytes_view>;
+        using base_t = std::conditional_t<Const, const Rng, Rng>;
+
+        input_cursor() = default;
+
+        input_cursor(view_t& view)
+                : first_(rng::begin(view.base_)),
+                  last_(rng::end(view.base_)),
+                  swap_(detail::make_swap_flag(view.order_ != boost::endian::order::native,
+                                               swap_flag{}))
+        {
+            read_unit();
+
+            if (view.consume_bom_ && !done_) {
+                const auto u = static_cast<detail::uint_of_size_t<CharT>>(value_);
+                if (u == 0xFEFFu) {
+                    read_unit();
+                } else if (u == detail::swapped_bom_value<CharT>()) {
+                    detail::flip_swap_flag(swap_);
+                    read_unit();
+                }
+            }
+        }
+
+        void read_unit()
+        {
+            std::array<byte, sizeof(CharT)> buf;
+            for (auto& b : buf) {
+                if (first_ == last_) {
+                    done_ = true;
+                    return;
+                }
+                b = static_cast<byte>(*first_);
+                ++first_;
+            }
+            value_ = detail::load_code_unit<CharT>(buf.data(), swap_);
+        }
+
+        CharT get() const { return value_; }
+
+        void next() { read_unit(); }
+
+        bool done() const { return done_; }
+
+        CONCEPT_REQUIRES(rng::ForwardRange<base_t>())
+        bool equal(const input_cursor& other) const
+        {
+            return first_ == other.first_ && done_ == other.done_;
+        }
+
+        rng::range_iterator_t<base_t> first_{};
+        rng::range_sentinel_t<base_t> last_{};
+        CharT value_{};
+        swap_flag swap_{};
+        bool done_ = false;
+    };
+
+    // Returns a pointer to the first byte of the first code unit to be
+    // read, skipping a BOM if requested, and sets swap accordingly
+    const byte* contiguous_first(bool& swap) const
+    {
+        const byte* first = reinterpret_cast<const byte*>(rng::begin(base_));
+        swap = order_ != boost::endian::order::native;
+
+        if (consume_bom_ && contiguous_last() - first >= std::ptrdiff_t{sizeof(CharT)}) {
+            const auto u = static_cast<detail::uint_of_size_t<CharT>>(
+                    detail::load_code_unit<CharT>(first, swap));
+            if (u == 0xFEFFu) {
+                first += sizeof(CharT);
+            } else if (u == detail::swapped_bom_value<CharT>()) {
+                first += sizeof(CharT);
+                swap = !swap;
+            }
+        }
+
+        return first;
+    }
+
+    const byte* contiguous_last() const
+    {
+        const std::size_t n = rng::end(base_) - rng::begin(base_);
+        return reinterpret_cast<const byte*>(rng::begin(base_)) +
+                (n - n % sizeof(CharT));
+    }
+
+    CONCEPT_REQUIRES(is_contiguous)
+    contiguous_cursor begin_cursor() const
+    {
+        bool swap = false;
+        const byte* first = contiguous_first(swap);
+        return {first, swap};
+    }
+
+    CONCEPT_REQUIRES(is_contiguous)
+    contiguous_cursor end_cursor() const
+    {
+        return {contiguous_last(), false};
+    }
+
+    CONCEPT_REQUIRES(!is_contiguous)
+    input_cursor<false> begin_cursor()
+    {
+        return input_cursor<false>{*this};
+    }
+
+    CONCEPT_REQUIRES(!is_contiguous && rng::Range<const Rng>())
+    input_cursor<true> begin_cursor() const
+    {
+        return input_cursor<true>{*this};
+    }
+
+public:
+    from_bytes_view() = default;
+
+    // With a fixed Mode, byte_order must match it, and consume_bom be false
+    from_bytes_view(Rng range,
+                    boost::endian::order byte_order = boost::endian::order::native,
+                    bool consume_bom = false)
+            : base_(std::move(range)),
+              order_(byte_order),
+              consume_bom_(consume_bom)
+    {}
+
+    Rng base() const { return base_; }
+
+    boost::endian::order byte_order() const { return order_; }
+
+    bool consumes_bom() const { return consume_bom_; }
+
+    /// For contiguous byte sources, returns a pointer to the first byte of
+    /// the first code unit the view will produce (that is, after any BOM)
+    CONCEPT_REQUIRES(is_contiguous)
+    const unsigned char* unit_bytes_begin() const
+    {
+        bool swap = false;
+        return contiguous_first(swap);
+    }
+
+    /// For contiguous byte sources, returns true if code units are being
+    /// reassembled in non-native byte order
+    CONCEPT_REQUIRES(is_contiguous)
+    bool reassembles_swapped() const
+    {
+        bool swap = false;
+        contiguous_first(swap);
+        return swap;
+    }
+
+    /// Returns a copy of this view which will strip a leading byte order mark
+    /// and, if the BOM indicates the opposite byte order to that requested,
+    /// reassemble the code units in that order instead. Since that is decided
+    /// at run time, the copy always has the dynamic swap_mode.
+    from_bytes_view<Rng, CharT> with_bom_detection() const
+    {
+        return from_bytes_view<Rng, CharT>{base_, order_, true};
+    }
+
+private:
+    Rng base_{};
+    boost::endian::order order_ = boost::endian::order::native;
+    bool consume_bom_ = false;
+};
+
+namespace detail {
+
+template <typename T>
+struct is_from_bytes_view : std::false_type {};
+
+template <typename Rng, typename CharT, swap_mode Mode>
+struct is_from_bytes_view<from_bytes_view<Rng, CharT, Mode>> : std::true_type {};
+
+// The bytes underlying a from_bytes view. Contiguous ranges are reduced to a
+// pair of pointers, so that the view is random-access.
+template <typename Range,
+          CONCEPT_REQUIRES_(is_contiguous_range<Range>())>
+rng::iterator_range<const unsigned char*> byte_source(Range&& range)
+{
+    // The range is reinterpreted as raw bytes, so from_bytes_view's own
+    // check would only ever see unsigned char
+    static_assert(sizeof(rng::range_value_t<Range>) == 1,
+                  "view::from_bytes requires a range of bytes");
+    const auto first = reinterpret_cast<const unsigned char*>(contiguous_data(range));
+    return {first, first + contiguous_size(range)};
+}
+
+template <typename Range,
+          CONCEPT_REQUIRES_(rng::InputRange<Range>() && !is_contiguous_range<Range>())>
+rng::view::all_t<Range> byte_source(Range&& range)
+{
+    return rng::view::all(std::forward<Range>(range));
+}
+
+template <typename Range>
+using byte_source_t = decltype(byte_source(std::declval<Range>()));
+
+} // end namespace detail
+
+namespace view {
+
+template <typename CharT>
+struct from_bytes_fn {
+    template <typename Range,
+              CONCEPT_REQUIRES_(rng::InputRange<Range>())>
+    from_bytes_view<utf_ranges::detail::byte_source_t<Range>, CharT>
+    operator()(Range&& range,
+               boost::endian::order byte_order = boost::endian::order::native) const
+    {
+        return {utf_ranges::detail::byte_source(std::forward<Range>(range)), byte_order};
+    }
+
+    decltype(auto) operator()(boost::endian::order byte_order = boost::endian::order::native) const
+    {
+        return rng::make_pipeable(std::bind(*this, std::placeholders::_1,
+                                            rng::protect(byte_order)));
+    }
+};
+
+// The byte order known at compile time: each code unit is either always or
+// never swapped, with no run-time check
+template <typename CharT, boost::endian::order Order>
+struct static_from_bytes_fn {
+    template <typename Range,
+              CONCEPT_REQUIRES_(rng::InputRange<Range>())>
+    from_bytes_view<utf_ranges::detail::byte_source_t<Range>, CharT,
+                    utf_ranges::detail::fixed_swap_mode(Order)>
+    operator()(Range&& range) const
+    {
+        return {utf_ranges::detail::byte_source(std::forward<Range>(range)), Order};
+    }
+
+    decltype(auto) operator()() const
+    {
+        return rng::make_pipeable(std::bind(*this, std::placeholders::_1));
+    }
+};
+
+// from_bytes<CharT> takes the byte order as a run-time argument;
+// from_bytes<CharT, Order> fixes it at compile time
+template <typename CharT, boost::endian::order... Order>
+struct from_bytes_selector {
+    static_assert(sizeof...(Order) <= 1,
+                  "from_bytes takes at most one byte order");
+};
+
+template <typename CharT>
+struct from_bytes_selector<CharT> {
+    using type = from_bytes_fn<CharT>;
+};
+
+template <typename CharT, boost::endian::order Order>
+struct from_bytes_selector<CharT, Order> {
+    using type = static_from_bytes_fn<CharT, Order>;
+};
+
+inline namespace
+{
+    template <typename CharT, boost::endian::order... Order>
+    constexpr auto& from_bytes = static_const<rng::view::view<
+            typename from_bytes_selector<CharT, Order...>::type>>::value;
+}
+
+} // end namespace view
+} // end namespace utf_ranges
+} // end namespace tcb
+
+#endif // TCB_UTF_RANGES_VIEW_FROM_BYTES_HPP_INCLUDED
@@ -1,4 +1,3 @@
-
 // Copyright (c) 2016 Tristan Brindle (tcbrindle at gmail dot com)
 // Distributed under the Boost Software License, Version 1.0. (See accompanying
 // file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
@@ -6,86 +5,216 @@
 #ifndef TCB_UTF_RANGES_VIEW_LINE_END_TRANSFORM_HPP_INCLUDED
 #define TCB_UTF_RANGES_VIEW_LINE_END_TRANSFORM_HPP_INCLUDED
 
-#include <range/v3/view_adaptor.hpp>
-#include <tcb/utf_ranges/view/utf_convert.hpp>
+#include <range/v3/view_facade.hpp>
+#include <range/v3/view/view.hpp>
+
+#include <tcb/utf_ranges/detail/contiguous.hpp>
+#include <tcb/utf_ranges/detail/line_end.hpp>
+#include <tcb/utf_ranges/line_end.hpp>
+
+#include <array>
+#include <cstdint>
 
 namespace tcb {
 namespace utf_ranges {
 
 namespace rng = ::ranges::v3;
+using rng::static_const;
+
+namespace detail {
+
+// For code units in memory, returns the position of the next candidate, so
+// that everything before it can be passed straight through
+template <typename I, typename S,
+          CONCEPT_REQUIRES_(std::is_pointer<I>() && std::is_same<I, S>())>
+I next_line_end_candidate(I first, S last, line_end target)
+{
+    return target == line_end::preserve
+            ? last
+            : find_line_end_candidate(first, last, target != line_end::lf);
+}
+
+// Otherwise, we don't want to read through the underlying range twice, so
+// just check each code unit as we reach it
+template <typename I, typename S,
+          CONCEPT_REQUIRES_(!(std::is_pointer<I>() && std::is_same<I, S>()))>
+I next_line_end_candidate(I first, S /*last*/, line_end /*target*/)
+{
+    return first;
+}
+
+} // end namespace detail
 
+/// View which converts all eight Unicode line endings (including CRLF pairs)
+/// to the given target, working directly on UTF-8, UTF-16 or UTF-32 code
+/// units. The underlying range is only read once, in order, so this works
+/// with single-pass input ranges such as istreambuf_range.
+///
+/// For contiguous input, a vectorised scan finds the next code unit which
+/// could start a line ending, and everything before it is passed through
+/// without further checks.
 template <typename Rng>
 class line_end_transform_view
-        : public rng::view_adaptor<line_end_transform_view<Rng>, Rng>
+        : public rng::view_facade<line_end_transform_view<Rng>, rng::unknown>
 {
-private:
+    using char_type = rng::range_value_t<Rng>;
+
+    static_assert(sizeof(char_type) == 1 || sizeof(char_type) == 2 ||
+                  sizeof(char_type) == 4,
+                  "line_end_transform requires a range of UTF-8, UTF-16 or UTF-32 code units");
+
     friend rng::range_access;
 
-    struct adaptor : rng::adaptor_base {
-        adaptor() = default;
+    template <bool Const>
+    struct cursor {
+        using base_t = std::conditional_t<Const, const Rng, Rng>;
+        using iterator_t = rng::range_iterator_t<base_t>;
+        using sentinel_t = rng::range_sentinel_t<base_t>;
+        using transformer_t = line_end_transformer<char_type>;
 
-        char32_t get(rng::range_iterator_t<Rng> it) const
+        static constexpr bool is_contiguous =
+                std::is_pointer<iterator_t>::value &&
+                std::is_same<iterator_t, sentinel_t>::value;
+
+        cursor() = default;
+
+        cursor(iterator_t first, sentinel_t last, line_end target)
+                : it_(first),
+                  clean_end_(detail::next_line_end_candidate(first, last, target)),
+                  last_(last),
+                  transformer_(target)
         {
-            char32_t c = *it;
-            switch (c) {
-            case U'\u0085': // Next line (NEL)
-            case U'\u000B': // Vertical tab (VT)
-            case U'\u000C': // Form feed (FF)
-            case U'\u2028': // Line separator (LS)
-            case U'\u2029': // Paragraph separator (PS)
-                c = U'\n';
-                break;
-            case U'\u000D': // Carriage return (CR)
-                c = U'\n';
-                // If next character is LF, skip it
-                skip_next_ = (*++it == U'\u000A');
-                break;
+            fill();
+        }
+
+        char_type get() const { return buf_[pos_]; }
+
+        void next()
+        {
+            if (++pos_ == len_) {
+                fill();
             }
+        }
+
+        bool done() const { return len_ == 0; }
 
-            return c;
+        CONCEPT_REQUIRES(rng::ForwardRange<base_t>())
+        bool equal(const cursor& other) const
+        {
+            return it_ == other.it_ && pos_ == other.pos_ && len_ == other.len_;
         }
 
-        void next(rng::range_iterator_t<Rng>& it)
+    private:
+        bool in_clean_run(std::true_type /*contiguous*/) const
         {
-            ++it;
-            if (skip_next_) {
-                ++it;
-                skip_next_ = false;
-            }
+            return it_ != clean_end_ && !transformer_.has_pending();
+        }
+
+        // Iterators of single-pass ranges might not even be comparable
+        bool in_clean_run(std::false_type /*contiguous*/) const
+        {
+            return false;
         }
 
-        bool equal(const adaptor& other) const
+        // Reads from the underlying range until the transformer gives us
+        // some output, or we reach the end
+        void fill()
         {
-            return skip_next_ == other.skip_next_;
+            pos_ = 0;
+            len_ = 0;
+
+            while (len_ == 0) {
+                if (it_ == last_) {
+                    len_ = static_cast<std::uint8_t>(
+                            transformer_.flush(buf_.data()) - buf_.data());
+                    return;
+                }
+
+                if (in_clean_run(std::integral_constant<bool, is_contiguous>{})) {
+                    buf_[0] = *it_;
+                    ++it_;
+                    len_ = 1;
+                    return;
+                }
+
+                len_ = static_cast<std::uint8_t>(
+                        transformer_.put(static_cast<char_type>(*it_), buf_.data()) - buf_.data());
+                ++it_;
+
+                if (is_contiguous && !transformer_.has_pending()) {
+                    clean_end_ = detail::next_line_end_candidate(it_, last_,
+                                                                 transformer_.target());
+                }
+            }
         }
 
-        mutable bool skip_next_ = false;
+        iterator_t it_{};
+        iterator_t clean_end_{};
+        sentinel_t last_{};
+        transformer_t transformer_{};
+        std::array<char_type, transformer_t::max_output> buf_{};
+        std::uint8_t pos_ = 0;
+        std::uint8_t len_ = 0;
     };
 
-public:
+    CONCEPT_REQUIRES(!rng::Range<const Rng>())
+    cursor<false> begin_cursor()
+    {
+        return {rng::begin(base_), rng::end(base_), target_};
+    }
 
-    adaptor begin_adaptor() const { return adaptor{}; }
+    CONCEPT_REQUIRES(rng::Range<const Rng>())
+    cursor<true> begin_cursor() const
+    {
+        return {rng::begin(base_), rng::end(base_), target_};
+    }
 
+public:
     line_end_transform_view() = default;
 
-    line_end_transform_view(Rng rng)
-        : rng::view_adaptor<line_end_transform_view, Rng>{std::move(rng)}
+    line_end_transform_view(Rng rng, line_end target = line_end::lf)
+        : base_(std::move(rng)),
+          target_(target)
     {}
+
+    Rng base() const { return base_; }
+
+    line_end target() const { return target_; }
+
+private:
+    Rng base_{};
+    line_end target_ = line_end::lf;
 };
 
-namespace view {
+namespace detail {
+
+template <typename T>
+struct is_line_end_transform_view : std::false_type {};
 
 template <typename Rng>
-auto line_end_transform(Rng&& range)
-{
-    // Convert to UTF-32 and then back again
-    using CharT = rng::range_value_t<Rng>;
-    using R = decltype(rng::view::all(utf32(std::forward<Rng>(range))));
-    return utf_convert<CharT>(
-        line_end_transform_view<R>{rng::view::all(utf32(std::forward<Rng>(range)))}
-    );
-}
+struct is_line_end_transform_view<line_end_transform_view<Rng>> : std::true_type {};
+
+} // end namespace detail
+
+namespace view {
+
+struct line_end_transform_fn {
+    template <typename Range,
+              CONCEPT_REQUIRES_(rng::InputRange<Range>())>
+    line_end_transform_view<utf_ranges::detail::view_all_t<Range>>
+    operator()(Range&& range, line_end target = line_end::lf) const
+    {
+        return {utf_ranges::detail::view_all(std::forward<Range>(range)), target};
+    }
+
+    decltype(auto) operator()(line_end target = line_end::lf) const
+    {
+        return rng::make_pipeable(std::bind(*this, std::placeholders::_1,
+                                            rng::protect(target)));
+    }
+};
 
+RANGES_INLINE_VARIABLE(rng::view::view<line_end_transform_fn>, line_end_transform);
 
 } // end namespace view
 } // end namespace utf_ranges
@@ -0,0 +1,178 @@
+// Copyright (c) 2016 Tristan Brindle (tcbrindle at gmail dot com)
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef TCB_UTF_RANGES_VIEW_LINES_HPP_INCLUDED
+#define TCB_UTF_RANGES_VIEW_LINES_HPP_INCLUDED
+
+#include <range/v3/view_facade.hpp>
+#include <range/v3/view/view.hpp>
+
+#include <tcb/utf_ranges/detail/contiguous.hpp>
+#include <tcb/utf_ranges/detail/line_end.hpp>
+
+#include <string>
+
+namespace tcb {
+namespace utf_ranges {
+
+namespace rng = ::ranges::v3;
+using rng::static_const;
+
+/// A single line of text, referring into the original string. The line's
+/// contents do not include its terminator, but the kind of terminator it
+/// had (if any) is available from terminator().
+template <typename CharT>
+class line_ref {
+public:
+    using value_type = CharT;
+    using iterator = const CharT*;
+
+    line_ref() = default;
+
+    line_ref(const CharT* first, const CharT* last,
+             line_terminator terminator = line_terminator::none)
+        : first_(first),
+          last_(last),
+          terminator_(terminator)
+    {}
+
+    const CharT* begin() const { return first_; }
+
+    const CharT* end() const { return last_; }
+
+    const CharT* data() const { return first_; }
+
+    std::size_t size() const { return last_ - first_; }
+
+    bool empty() const { return first_ == last_; }
+
+    line_terminator terminator() const { return terminator_; }
+
+    /// Returns a copy of the contents of the line
+    std::basic_string<CharT> str() const { return {first_, last_}; }
+
+private:
+    const CharT* first_ = nullptr;
+    const CharT* last_ = nullptr;
+    line_terminator terminator_ = line_terminator::none;
+};
+
+/// View which splits contiguous UTF-8, UTF-16 or UTF-32 text into lines, at
+/// any of the eight Unicode line terminators. Each element is a line_ref
+/// pointing into the original text, so no copying takes place. A terminator
+/// at the very end of the text does not start a new (empty) line.
+///
+/// Line ends are found with the same vectorised scan as line_end_transform.
+template <typename CharT>
+class lines_view
+        : public rng::view_facade<lines_view<CharT>, rng::finite>
+{
+    friend rng::range_access;
+
+    struct cursor {
+        cursor() = default;
+
+        cursor(const CharT* first, const CharT* last)
+                : first_(first),
+                  last_(last)
+        {
+            find_line_end();
+        }
+
+        line_ref<CharT> get() const
+        {
+            return {first_, line_last_, terminator_};
+        }
+
+        void next()
+        {
+            first_ = next_;
+            find_line_end();
+        }
+
+        bool done() const { return first_ == last_; }
+
+        bool equal(const cursor& other) const
+        {
+            return first_ == other.first_;
+        }
+
+    private:
+        void find_line_end()
+        {
+            const CharT* p = first_;
+
+            while (p != last_) {
+                p = detail::find_line_end_candidate(p, last_, true);
+                if (p == last_) {
+                    break;
+                }
+
+                const CharT* q = p;
+                terminator_ = detail::match_line_end(q, last_);
+                if (terminator_ != line_terminator::none) {
+                    line_last_ = p;
+                    next_ = q;
+                    return;
+                }
+                ++p;
+            }
+
+            line_last_ = next_ = last_;
+            terminator_ = line_terminator::none;
+        }
+
+        const CharT* first_ = nullptr;
+        const CharT* line_last_ = nullptr;
+        const CharT* next_ = nullptr;
+        const CharT* last_ = nullptr;
+        line_terminator terminator_ = line_terminator::none;
+    };
+
+    cursor begin_cursor() const
+    {
+        return {first_, last_};
+    }
+
+public:
+    lines_view() = default;
+
+    lines_view(const CharT* first, const CharT* last)
+        : first_(first),
+          last_(last)
+    {}
+
+private:
+    const CharT* first_ = nullptr;
+    const CharT* last_ = nullptr;
+};
+
+namespace view {
+
+struct lines_fn {
+    template <typename Range,
+              typename CharT = rng::range_value_t<Range>,
+              CONCEPT_REQUIRES_(utf_ranges::detail::is_contiguous_range<Range>())>
+    lines_view<CharT> operator()(Range&& range) const
+    {
+        static_assert(sizeof(CharT) == 1 || sizeof(CharT) == 2 || sizeof(CharT) == 4,
+                      "view::lines requires a range of UTF-8, UTF-16 or UTF-32 code units");
+
+        const CharT* first = utf_ranges::detail::contiguous_data(range);
+        return {first, first + utf_ranges::detail::contiguous_size(range)};
+    }
+
+    decltype(auto) operator()() const
+    {
+        return rng::make_pipeable(std::bind(*this));
+    }
+};
+
+RANGES_INLINE_VARIABLE(rng::view::view<lines_fn>, lines);
+
+} // end namespace view
+} // end namespace utf_ranges
+} // end namespace tcb
+
+#endif // TCB_UTF_RANGES_VIEW_LINES_HPP_INCLUDED
@@ -10,6 +10,8 @@
 #include <range/v3/view/all.hpp>
 #include <range/v3/view/view.hpp>
 
+#include <tcb/utf_ranges/detail/ascii.hpp>
+#include <tcb/utf_ranges/detail/contiguous.hpp>
 #include <tcb/utf_ranges/detail/utf.hpp>
 
 namespace tcb {
@@ -29,8 +31,7 @@ class utf_convert_view
                   last_(rng::end(parent.range_))
         {
             if (first_ != last_) {
-                char32_t c = detail::utf_traits<InCharT>::decode(first_, last_);
-                next_chars_ = detail::utf_traits<OutCharT>::encode(c);
+                read();
             }
         }
 
@@ -39,20 +40,32 @@ class utf_convert_view
                   last_(rng::end(parent.range_))
         {
             if (first_ != last_) {
-                char32_t c = detail::utf_traits<InCharT>::decode(first_, last_);
-                next_chars_ = detail::utf_traits<OutCharT>::encode(c);
+                read();
             }
         }
 
         void next()
         {
             if (++idx_ == next_chars_.size() && first_ != last_) {
-                char32_t c = detail::utf_traits<InCharT>::decode(first_, last_);
-                next_chars_ = detail::utf_traits<OutCharT>::encode(c);
+                read();
                 idx_ = 0;
             }
         }
 
+        // An ASCII code unit is the same code point in every encoding, so
+        // it needs neither decoding nor encoding
+        void read()
+        {
+            const auto u = *first_;
+            if (detail::is_ascii(u)) {
+                ++first_;
+                next_chars_ = detail::encoded_chars<OutCharT>{static_cast<OutCharT>(u)};
+                return;
+            }
+            char32_t c = detail::decode_or_replace<InCharT>(first_, last_);
+            next_chars_ = detail::utf_traits<OutCharT>::encode(c);
+        }
+
         OutCharT get() const
         {
             return next_chars_[idx_];
@@ -86,57 +99,52 @@ public:
     utf_convert_view(Range range)
             : range_{std::move(range)} {}
 
+    Range base() const { return range_; }
+
 private:
     Range range_{};
     friend rng::range_access;
 };
 
-namespace view {
+namespace detail {
 
-template <typename OutCharT>
-struct utf_convert_fn {
-    template <typename Range,
-              typename InCharT = rng::range_value_t<Range>>
-    utf_convert_view<rng::view::all_t<Range>, InCharT, OutCharT>
-    operator()(Range&& range) const
-    {
-        return {rng::view::all(std::forward<Range>(range))};
-    }
+template <typename T>
+struct is_utf_convert_view : std::false_type {};
 
-    decltype(auto) operator()() const
-    {
-        return rng::make_pipeable(std::bind(*this));
-    }
-};
+template <typename Range, typename InCharT, typename OutCharT>
+struct is_utf_convert_view<utf_convert_view<Range, InCharT, OutCharT>>
+        : std::true_type {};
 
-inline namespace
+template <typename OutCharT, typename Range,
+          CONCEPT_REQUIRES_(!is_utf_convert_view<std::decay_t<Range>>())>
+utf_convert_view<view_all_t<Range>, rng::range_value_t<Range>, OutCharT>
+make_utf_convert_view(Range&& range)
 {
-    template <typename OutCharT>
-    constexpr auto& utf_convert = static_const<rng::view::view<utf_convert_fn<OutCharT>>>::value;
+    return {view_all(std::forward<Range>(range))};
 }
 
-struct utf8_fn {
-    template <typename Range>
-    utf_convert_view<rng::view::all_t<Range>, rng::range_value_t<Range>, char>
-    operator()(Range&& range) const
-    {
-        return {rng::view::all(std::forward<Range>(range))};
-    }
+// Converting the output of another conversion view: that view only ever
+// produces valid UTF (anything invalid having been replaced by U+FFFD), so
+// converting directly from its source gives exactly the same result while
+// decoding only once. In particular, utf8(utf16(str)) for UTF-8 str becomes
+// a single validate-and-replace pass over str.
+template <typename OutCharT, typename Range, typename InCharT, typename MidCharT>
+utf_convert_view<Range, InCharT, OutCharT>
+make_utf_convert_view(const utf_convert_view<Range, InCharT, MidCharT>& view)
+{
+    return {view.base()};
+}
 
-    decltype(auto) operator()() const
-    {
-        return rng::make_pipeable(std::bind(*this));
-    }
-};
+} // end namespace detail
 
-RANGES_INLINE_VARIABLE(rng::view::view<utf8_fn>, utf8);
+namespace view {
 
-struct utf16_fn {
+template <typename OutCharT>
+struct utf_convert_fn {
     template <typename Range>
-    utf_convert_view<rng::view::all_t<Range>, rng::range_value_t<Range>, char16_t>
-    operator()(Range&& range) const
+    auto operator()(Range&& range) const
     {
-        return {rng::view::all(std::forward<Range>(range))};
+        return utf_ranges::detail::make_utf_convert_view<OutCharT>(std::forward<Range>(range));
     }
 
     decltype(auto) operator()() const
@@ -145,23 +153,17 @@ struct utf16_fn {
     }
 };
 
-RANGES_INLINE_VARIABLE(rng::view::view<utf16_fn>, utf16);
+inline namespace
+{
+    template <typename OutCharT>
+    constexpr auto& utf_convert = static_const<rng::view::view<utf_convert_fn<OutCharT>>>::value;
+}
 
-struct utf32_fn {
-    template <typename Range>
-    utf_convert_view<rng::view::all_t<Range>, rng::range_value_t<Range>, char32_t>
-    operator()(Range&& range) const
-    {
-        return {rng::view::all(std::forward<Range>(range))};
-    }
+RANGES_INLINE_VARIABLE(rng::view::view<utf_convert_fn<char>>, utf8);
 
-    decltype(auto) operator()() const
-    {
-        return rng::make_pipeable(std::bind(*this));
-    }
-};
+RANGES_INLINE_VARIABLE(rng::view::view<utf_convert_fn<char16_t>>, utf16);
 
-RANGES_INLINE_VARIABLE(rng::view::view<utf32_fn>, utf32);
+RANGES_INLINE_VARIABLE(rng::view::view<utf_convert_fn<char32_t>>, utf32);
 
 } // end namespace view
 } // end namespace utf_ranges
@@ -10,6 +10,7 @@
 #include <range/v3/algorithm/equal.hpp>
 #include <range/v3/istream_range.hpp>
 #include <iostream>
+#include <list>
 #include <sstream>
 
 #define TEST_STRING "$€0123456789你好abcdefghijklmnopqrstyvwxyz\U0001F60E"
@@ -126,6 +127,69 @@ TEST_CASE("InputRanges without byte order marks are unchanged", "[bom]")
     }
 }
 
+TEST_CASE("InputRanges shorter than a byte order mark are unchanged", "[bom]")
+{
+    std::stringstream ss;
+    ss << "ab";
+    const std::string test = tcb::utf_ranges::view::consume_bom(
+            ranges::istream_range<char>(ss));
+    REQUIRE(test == "ab");
+}
+
+TEST_CASE("Byte order marks can be prepended to InputRanges", "[bom]")
+{
+    std::stringstream ss;
+    ss << u8"" TEST_STRING;
+    const std::string test = tcb::utf_ranges::view::add_bom(
+            ranges::istream_range<char>(ss));
+    REQUIRE(test == u8"\ufeff" TEST_STRING);
+}
+
+TEST_CASE("add_bom views are sized forward ranges", "[bom]")
+{
+    const std::u16string str = u"" TEST_STRING;
+    const auto v = tcb::utf_ranges::view::add_bom(str);
+
+    static_assert(ranges::ForwardRange<decltype(v)>(), "");
+    REQUIRE(ranges::size(v) == str.size() + 1);
+    REQUIRE(ranges::distance(ranges::begin(v), ranges::end(v)) ==
+            static_cast<std::ptrdiff_t>(str.size() + 1));
+}
+
+TEST_CASE("add_bom views keep the category of the underlying range", "[bom]")
+{
+    SECTION("...for random-access ranges") {
+        const std::string str = u8"" TEST_STRING;
+        const auto v = tcb::utf_ranges::view::add_bom(str);
+        static_assert(ranges::RandomAccessRange<decltype(v)>(), "");
+
+        const auto first = ranges::begin(v);
+        auto it = first + 5;
+        REQUIRE(*it == str[2]);
+        REQUIRE(it - first == 5);
+        it -= 4;
+        REQUIRE(static_cast<unsigned char>(*it) == 0xBB);
+        REQUIRE(static_cast<unsigned char>(first[2]) == 0xBF);
+        REQUIRE(first[3] == str[0]);
+        it -= 1;
+        REQUIRE(it == first);
+    }
+
+    SECTION("...for bidirectional ranges") {
+        const std::list<char16_t> list = {u'a', u'b'};
+        const auto v = tcb::utf_ranges::view::add_bom(list);
+        static_assert(ranges::BidirectionalRange<decltype(v)>(), "");
+
+        auto it = ranges::next(ranges::begin(v), 2);
+        REQUIRE(*it == u'b');
+        --it;
+        REQUIRE(*it == u'a');
+        --it;
+        REQUIRE(*it == u'\uFEFF');
+        REQUIRE(it == ranges::begin(v));
+    }
+}
+
 TEST_CASE("Byte order marks are correctly used", "[bom]")
 {
     SECTION("...for \"UTF-8BE\"") {
@@ -175,4 +239,29 @@ TEST_CASE("Byte order marks are correctly used", "[bom]")
         const std::wstring test = tcb::utf_ranges::view::consume_bom(str);
         REQUIRE(test == L"" TEST_STRING);
     }
-}
\ No newline at end of file
+}
+
+TEST_CASE("Byte order marks can be dispatched on at compile time", "[bom]")
+{
+    const auto to_u16string = [] (const auto& view) {
+        return std::u16string(ranges::begin(view), ranges::end(view));
+    };
+
+    SECTION("...with native-endian BOMs") {
+        const std::u16string str = u"\uFEFF" TEST_STRING;
+        const std::u16string test = tcb::utf_ranges::view::consume_bom(str, to_u16string);
+        REQUIRE(test == u"" TEST_STRING);
+    }
+
+    SECTION("...with byte-swapped BOMs") {
+        const auto str = to_big_endian(std::u16string(u"\uFEFF" TEST_STRING));
+        const std::u16string test = tcb::utf_ranges::view::consume_bom(str, to_u16string);
+        REQUIRE(test == u"" TEST_STRING);
+    }
+
+    SECTION("...without BOMs") {
+        const std::u16string str = u"" TEST_STRING;
+        const std::u16string test = tcb::utf_ranges::view::consume_bom(str, to_u16string);
+        REQUIRE(test == u"" TEST_STRING);
+    }
+}
@@ -0,0 +1,158 @@
+// Copyright (c) 2016 Tristan Brindle (tcbrindle at gmail dot com)
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include "catch.hpp"
+
+#include <tcb/utf_ranges/code_point_index.hpp>
+#include <tcb/utf_ranges/code_points.hpp>
+
+#include <string>
+#include <type_traits>
+#include <utility>
+
+namespace utf = tcb::utf_ranges;
+
+#define TEST_STRING "Hello é你\U0001F60E"
+
+namespace {
+
+std::string make_test_string()
+{
+    std::string str;
+    for (int i = 0; i < 100; i++) {
+        str += u8"" TEST_STRING;
+    }
+    return str;
+}
+
+std::u32string make_test_u32string()
+{
+    std::u32string str;
+    for (int i = 0; i < 100; i++) {
+        str += U"" TEST_STRING;
+    }
+    return str;
+}
+
+template <typename Index, typename = void>
+struct can_index_utf32 : std::false_type {};
+
+template <typename Index>
+struct can_index_utf32<Index,
+        decltype(void(utf::view::indexed_utf32(std::declval<Index>())))>
+        : std::true_type {};
+
+}
+
+TEST_CASE("code_point_index finds code points with any stride", "[code_point_index]")
+{
+    const std::string str = make_test_string();
+
+    for (std::size_t stride : {1, 2, 7, 64, 256, 10000}) {
+        const utf::code_point_index index{str, stride};
+
+        REQUIRE(index.size() == 900);
+        REQUIRE(index.stride() == stride);
+        REQUIRE(index.num_code_units() == str.size());
+
+        for (std::size_t n = 0; n <= index.size(); n++) {
+            REQUIRE(index.offset_of(n) == utf::offset_of_code_point(str, n));
+        }
+        REQUIRE(index.offset_of(5000) == str.size());
+
+        for (std::size_t i = 0; i < str.size(); i++) {
+            const std::size_t n = index.index_of(i);
+            REQUIRE(index.offset_of(n) <= i);
+            REQUIRE(index.offset_of(n + 1) > i);
+        }
+        REQUIRE(index.index_of(str.size()) == index.size());
+    }
+}
+
+TEST_CASE("code_point_index memory use depends on the stride", "[code_point_index]")
+{
+    const std::string str = make_test_string();
+
+    const utf::code_point_index dense{str, 1};
+    const utf::code_point_index sparse{str, 100};
+
+    REQUIRE(dense.memory_usage() == 900 * sizeof(std::size_t));
+    REQUIRE(sparse.memory_usage() == 9 * sizeof(std::size_t));
+}
+
+TEST_CASE("code_point_index returns the code units of a range of code points",
+          "[code_point_index]")
+{
+    const std::string str = make_test_string();
+    const utf::code_point_index index{str, 16};
+
+    // Code points 7 to 9 of each repetition are "你😎"
+    const auto units = index.code_units(9 * 10 + 7, 9 * 10 + 9);
+    REQUIRE(std::string(units.begin(), units.end()) == u8"你\U0001F60E");
+
+    const auto empty = index.code_units(20, 10);
+    REQUIRE(empty.begin() == empty.end());
+
+    const auto tail = index.code_units(897, 5000);
+    REQUIRE(std::string(tail.begin(), tail.end()) == u8"é你\U0001F60E");
+}
+
+TEST_CASE("code_point_index works with UTF-16", "[code_point_index]")
+{
+    std::u16string str;
+    for (int i = 0; i < 100; i++) {
+        str += u"" TEST_STRING;
+    }
+    const utf::u16_code_point_index index{str, 8};
+
+    REQUIRE(index.size() == 900);
+    for (std::size_t n = 0; n <= index.size(); n++) {
+        REQUIRE(index.offset_of(n) == utf::offset_of_code_point(str, n));
+    }
+}
+
+TEST_CASE("code_point_index handles empty buffers", "[code_point_index]")
+{
+    const std::string str;
+    const utf::code_point_index index{str};
+
+    REQUIRE(index.empty());
+    REQUIRE(index.offset_of(0) == 0);
+    REQUIRE(index.index_of(0) == 0);
+}
+
+TEST_CASE("view::indexed_utf32 is a random-access view of the code points",
+          "[code_point_index]")
+{
+    const std::string str = make_test_string();
+    const std::u32string check = make_test_u32string();
+    const utf::code_point_index index{str, 32};
+
+    const auto view = utf::view::indexed_utf32(index);
+
+    // The view would dangle if made from a temporary index
+    static_assert(can_index_utf32<const utf::code_point_index&>::value, "");
+    static_assert(can_index_utf32<utf::code_point_index&>::value, "");
+    static_assert(!can_index_utf32<utf::code_point_index>::value, "");
+
+    REQUIRE(view.size() == check.size());
+    REQUIRE(std::u32string(view.begin(), view.end()) == check);
+
+    for (std::size_t n = 0; n < check.size(); n += 13) {
+        REQUIRE(view.begin()[static_cast<std::ptrdiff_t>(n)] == check[n]);
+    }
+
+    auto it = view.end();
+    for (auto c = check.rbegin(); c != check.rend(); ++c) {
+        --it;
+        REQUIRE(*it == *c);
+    }
+    REQUIRE(it == view.begin());
+
+    it += 500;
+    REQUIRE(*it == check[500]);
+    it += -250;
+    REQUIRE(*it == check[250]);
+    REQUIRE(view.end() - it == 650);
+}
@@ -0,0 +1,117 @@
+// Copyright (c) 2016 Tristan Brindle (tcbrindle at gmail dot com)
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include "catch.hpp"
+
+#include <tcb/utf_ranges/code_points.hpp>
+
+#include <list>
+#include <string>
+#include <vector>
+
+namespace utf = tcb::utf_ranges;
+
+#define TEST_STRING "Hello é你\U0001F60E"
+
+namespace {
+
+// Long enough for several blocks, with code points of every length falling
+// across the block boundaries
+template <typename CharT>
+std::basic_string<CharT> repeat(const CharT* str, int times)
+{
+    std::basic_string<CharT> out;
+    for (int i = 0; i < times; i++) {
+        out += str;
+    }
+    return out;
+}
+
+}
+
+TEST_CASE("count_code_points() counts code points", "[code_points]")
+{
+    // "Hello é你😎" has 9 code points
+    SECTION("UTF-8") {
+        REQUIRE(utf::count_code_points(std::string{}) == 0);
+        REQUIRE(utf::count_code_points(std::string(u8"" TEST_STRING)) == 9);
+        REQUIRE(utf::count_code_points(repeat(u8"" TEST_STRING, 50)) == 450);
+    }
+
+    SECTION("UTF-16") {
+        REQUIRE(utf::count_code_points(std::u16string(u"" TEST_STRING)) == 9);
+        REQUIRE(utf::count_code_points(repeat(u"" TEST_STRING, 50)) == 450);
+    }
+
+    SECTION("UTF-32") {
+        REQUIRE(utf::count_code_points(repeat(U"" TEST_STRING, 50)) == 450);
+    }
+
+    SECTION("Non-contiguous input") {
+        const std::string str = repeat(u8"" TEST_STRING, 50);
+        const std::list<char> list(str.begin(), str.end());
+        REQUIRE(utf::count_code_points(list) == 450);
+    }
+
+    SECTION("A stray trail unit belongs to the code point before it") {
+        REQUIRE(utf::count_code_points(std::string("a\x80" "b")) == 2);
+        REQUIRE(utf::count_code_points(std::string("\x80" "b")) == 2);
+    }
+}
+
+TEST_CASE("offset_of_code_point() finds the start of each code point", "[code_points]")
+{
+    const std::string str = repeat(u8"" TEST_STRING, 20);
+    const std::list<char> list(str.begin(), str.end());
+    const std::u16string u16 = repeat(u"" TEST_STRING, 20);
+
+    // Each repetition is 15 bytes and 10 UTF-16 code units
+    const std::vector<std::size_t> u8_offsets{0, 1, 2, 3, 4, 5, 6, 8, 11};
+    const std::vector<std::size_t> u16_offsets{0, 1, 2, 3, 4, 5, 6, 7, 8};
+
+    for (std::size_t i = 0; i < 180; i++) {
+        REQUIRE(utf::offset_of_code_point(str, i) == 15 * (i / 9) + u8_offsets[i % 9]);
+        REQUIRE(utf::offset_of_code_point(list, i) == 15 * (i / 9) + u8_offsets[i % 9]);
+        REQUIRE(utf::offset_of_code_point(u16, i) == 10 * (i / 9) + u16_offsets[i % 9]);
+    }
+
+    REQUIRE(utf::offset_of_code_point(str, 180) == str.size());
+    REQUIRE(utf::offset_of_code_point(str, 1000) == str.size());
+    REQUIRE(utf::offset_of_code_point(list, 1000) == str.size());
+    REQUIRE(utf::offset_of_code_point(std::string{}, 0) == 0);
+}
+
+TEST_CASE("advance_code_points() moves by code points", "[code_points]")
+{
+    const std::string str = repeat(u8"" TEST_STRING, 20);
+
+    SECTION("Forwards") {
+        const char* it = str.data();
+        REQUIRE(utf::advance_code_points(it, 8, str.data() + str.size()) == 0);
+        REQUIRE(it == str.data() + 11);
+        REQUIRE(utf::advance_code_points(it, 100, str.data() + str.size()) == 0);
+        REQUIRE(it == str.data() + 15 * 12);
+        REQUIRE(utf::advance_code_points(it, 100, str.data() + str.size()) == 28);
+        REQUIRE(it == str.data() + str.size());
+    }
+
+    SECTION("Backwards") {
+        auto it = str.end();
+        REQUIRE(utf::advance_code_points(it, -1, str.begin()) == 0);
+        REQUIRE(it == str.end() - 4);
+        REQUIRE(utf::advance_code_points(it, -2, str.begin()) == 0);
+        REQUIRE(it == str.end() - 9);
+        REQUIRE(utf::advance_code_points(it, -200, str.begin()) == -23);
+        REQUIRE(it == str.begin());
+    }
+
+    SECTION("Non-contiguous input") {
+        const std::list<char> list(str.begin(), str.end());
+        auto it = list.begin();
+        REQUIRE(utf::advance_code_points(it, 9, list.end()) == 0);
+        REQUIRE(std::distance(list.begin(), it) == 15);
+        REQUIRE(utf::advance_code_points(it, -2, list.begin()) == 0);
+        REQUIRE(std::distance(list.begin(), it) == 8);
+    }
+}
@@ -0,0 +1,145 @@
+// Copyright (c) 2016 Tristan Brindle (tcbrindle at gmail dot com)
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include "catch.hpp"
+
+#include <tcb/utf_ranges/convert.hpp>
+
+#include <array>
+#include <list>
+#include <string>
+
+namespace utf = tcb::utf_ranges;
+
+#define TEST_STRING "Hello é你\U0001F60E"
+
+TEST_CASE("Eager conversions work for short and long inputs", "[convert]")
+{
+    const std::string short_str = u8"" TEST_STRING;
+    const std::u32string short_check = U"" TEST_STRING;
+
+    std::string long_str;
+    std::u32string long_check;
+    for (int i = 0; i < 20; i++) {
+        long_str += short_str;
+        long_check += short_check;
+    }
+
+    REQUIRE(short_str.size() <= utf::detail::small_string_threshold);
+    REQUIRE(long_str.size() > utf::detail::small_string_threshold);
+
+    SECTION("Contiguous input") {
+        REQUIRE(utf::to_u32string(short_str) == short_check);
+        REQUIRE(utf::to_u32string(long_str) == long_check);
+    }
+
+    SECTION("Rvalue input") {
+        REQUIRE(utf::to_u32string(std::string(short_str)) == short_check);
+        REQUIRE(utf::to_u32string(std::string(long_str)) == long_check);
+    }
+
+    SECTION("Non-contiguous input") {
+        const std::list<char> short_list(short_str.begin(), short_str.end());
+        const std::list<char> long_list(long_str.begin(), long_str.end());
+        REQUIRE(utf::to_u32string(short_list) == short_check);
+        REQUIRE(utf::to_u32string(long_list) == long_check);
+    }
+
+    SECTION("Round trips") {
+        REQUIRE(utf::to_u8string(utf::to_u16string(short_str)) == short_str);
+        REQUIRE(utf::to_u8string(utf::to_u16string(long_str)) == long_str);
+    }
+}
+
+TEST_CASE("Short inputs which expand the most are converted correctly", "[convert]")
+{
+    constexpr std::size_t n = utf::detail::small_string_threshold;
+
+    SECTION("Invalid UTF-8") {
+        const std::string str(n, '\xFF');
+        std::string check;
+        for (std::size_t i = 0; i < n; i++) {
+            check += u8"\uFFFD";
+        }
+        REQUIRE(utf::to_u8string(str) == check);
+    }
+
+    SECTION("UTF-16 to UTF-8") {
+        const std::u16string str(n, u'你');
+        std::string check;
+        for (std::size_t i = 0; i < n; i++) {
+            check += u8"你";
+        }
+        REQUIRE(utf::to_u8string(str) == check);
+    }
+
+    SECTION("UTF-32 to UTF-8") {
+        const std::u32string str(n, U'\U0001F60E');
+        std::string check;
+        for (std::size_t i = 0; i < n; i++) {
+            check += u8"\U0001F60E";
+        }
+        REQUIRE(utf::to_u8string(str) == check);
+    }
+}
+
+TEST_CASE("utf_convert() returns the end of its output", "[convert]")
+{
+    const std::string str = u8"" TEST_STRING;
+    std::array<char16_t, 16> buf{};
+
+    char16_t* const last = utf::utf_convert<char16_t>(str, buf.data());
+
+    REQUIRE(std::u16string(buf.data(), last) == u"" TEST_STRING);
+}
+
+TEST_CASE("ASCII runs of any length and alignment are converted correctly", "[convert]")
+{
+    // Runs of ASCII either side of every block boundary, broken up by
+    // multi-byte and invalid sequences
+    std::string str;
+    std::u32string check;
+    for (std::size_t n = 0; n < 70; n++) {
+        const char c = static_cast<char>('a' + n % 26);
+        str += std::string(n, c) + u8"é";
+        check += std::u32string(n, static_cast<char32_t>(c)) + U"é";
+        if (n % 7 == 0) {
+            str += "\xFF";
+            check += U"\uFFFD";
+        }
+    }
+    str += std::string(1000, 'z') + u8"\U0001F60E";
+    check += std::u32string(1000, U'z') + U"\U0001F60E";
+
+    REQUIRE(utf::to_u32string(str) == check);
+    REQUIRE(utf::to_u32string(utf::to_u16string(str)) == check);
+    REQUIRE(utf::to_u32string(utf::to_u8string(check)) == check);
+
+    std::u16string out;
+    utf::utf_convert<char16_t>(str, std::back_inserter(out));
+    REQUIRE(out == utf::to_u16string(check));
+}
+
+TEST_CASE("ascii_prefix_length() finds the first non-ASCII code unit", "[convert]")
+{
+    REQUIRE(utf::ascii_prefix_length(std::string{}) == 0);
+    REQUIRE(utf::ascii_prefix_length(std::string(100, 'x')) == 100);
+
+    for (std::size_t i = 0; i < 100; i++) {
+        std::string str(100, 'x');
+        str[i] = '\x80';
+        REQUIRE(utf::ascii_prefix_length(str) == i);
+
+        std::u16string u16(100, u'x');
+        u16[i] = u'Ā';
+        REQUIRE(utf::ascii_prefix_length(u16) == i);
+
+        std::u32string u32(100, U'x');
+        u32[i] = U'\U00010000';
+        REQUIRE(utf::ascii_prefix_length(u32) == i);
+
+        const std::list<char> list(str.begin(), str.end());
+        REQUIRE(utf::ascii_prefix_length(list) == i);
+    }
+}
@@ -0,0 +1,137 @@
+// Copyright (c) 2016 Tristan Brindle (tcbrindle at gmail dot com)
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include "catch.hpp"
+#include "to_bytes.hpp"
+
+#include <tcb/utf_ranges/detect_encoding.hpp>
+
+#include <list>
+
+#define TEST_STRING "$€0123456789你好abcdefghijklmnopqrstyvwxyz\U0001F60E"
+
+using namespace tcb::utf_ranges;
+using boost::endian::order;
+
+using test::to_bytes;
+
+TEST_CASE("Encodings are detected from byte order marks", "[detect_encoding]")
+{
+    SECTION("...for UTF-8") {
+        const std::string bytes = u8"\uFEFF" TEST_STRING;
+        REQUIRE(detect_encoding(bytes) == (encoding_info{encoding::utf8, 3}));
+    }
+
+    SECTION("...for UTF-16LE") {
+        const auto bytes = to_bytes(std::u16string(u"\uFEFF" TEST_STRING), order::little);
+        REQUIRE(detect_encoding(bytes) == (encoding_info{encoding::utf16le, 2}));
+    }
+
+    SECTION("...for UTF-16BE") {
+        const auto bytes = to_bytes(std::u16string(u"\uFEFF" TEST_STRING), order::big);
+        REQUIRE(detect_encoding(bytes) == (encoding_info{encoding::utf16be, 2}));
+    }
+
+    SECTION("...for UTF-32LE") {
+        const auto bytes = to_bytes(std::u32string(U"\uFEFF" TEST_STRING), order::little);
+        REQUIRE(detect_encoding(bytes) == (encoding_info{encoding::utf32le, 4}));
+    }
+
+    SECTION("...for UTF-32BE") {
+        const auto bytes = to_bytes(std::u32string(U"\uFEFF" TEST_STRING), order::big);
+        REQUIRE(detect_encoding(bytes) == (encoding_info{encoding::utf32be, 4}));
+    }
+}
+
+TEST_CASE("Encodings are detected heuristically without byte order marks", "[detect_encoding]")
+{
+    SECTION("...for UTF-8") {
+        const std::string bytes = u8"" TEST_STRING;
+        REQUIRE(detect_encoding(bytes).form == encoding::utf8);
+    }
+
+    SECTION("...for UTF-16LE") {
+        const auto bytes = to_bytes(std::u16string(u"" TEST_STRING), order::little);
+        REQUIRE(detect_encoding(bytes) == (encoding_info{encoding::utf16le, 0}));
+    }
+
+    SECTION("...for UTF-16BE") {
+        const auto bytes = to_bytes(std::u16string(u"" TEST_STRING), order::big);
+        REQUIRE(detect_encoding(bytes) == (encoding_info{encoding::utf16be, 0}));
+    }
+
+    SECTION("...for UTF-32LE") {
+        const auto bytes = to_bytes(std::u32string(U"" TEST_STRING), order::little);
+        REQUIRE(detect_encoding(bytes) == (encoding_info{encoding::utf32le, 0}));
+    }
+
+    SECTION("...for UTF-32BE") {
+        const auto bytes = to_bytes(std::u32string(U"" TEST_STRING), order::big);
+        REQUIRE(detect_encoding(bytes) == (encoding_info{encoding::utf32be, 0}));
+    }
+
+    SECTION("...for non-contiguous ranges") {
+        const auto bytes = to_bytes(std::u16string(u"" TEST_STRING), order::big);
+        const std::list<char> list(bytes.begin(), bytes.end());
+        REQUIRE(detect_encoding(list) == (encoding_info{encoding::utf16be, 0}));
+    }
+
+    SECTION("...for empty ranges") {
+        REQUIRE(detect_encoding(std::string{}).form == encoding::utf8);
+    }
+
+    // With no spaces, there are no zero bytes; read as UTF-8, each letter's
+    // high-order byte 0x04 is a control character
+    SECTION("...for UTF-16 with no ASCII characters") {
+        const std::u16string word = u"достопримечательности";
+        REQUIRE(detect_encoding(to_bytes(word, order::little)) ==
+                (encoding_info{encoding::utf16le, 0}));
+        REQUIRE(detect_encoding(to_bytes(word, order::big)) ==
+                (encoding_info{encoding::utf16be, 0}));
+    }
+}
+
+TEST_CASE("decode_any decodes all encodings", "[detect_encoding]")
+{
+    const std::u32string expected = U"" TEST_STRING;
+
+    SECTION("...for UTF-8") {
+        const std::string bytes = u8"\uFEFF" TEST_STRING;
+        REQUIRE(decode_any<char32_t>(bytes) == expected);
+    }
+
+    SECTION("...for UTF-16BE") {
+        const auto bytes = to_bytes(std::u16string(u"\uFEFF" TEST_STRING), order::big);
+        REQUIRE(decode_any<char32_t>(bytes) == expected);
+    }
+
+    SECTION("...for UTF-16LE without a BOM") {
+        const auto bytes = to_bytes(std::u16string(u"" TEST_STRING), order::little);
+        REQUIRE(decode_any<char32_t>(bytes) == expected);
+    }
+
+    SECTION("...for UTF-32LE") {
+        const auto bytes = to_bytes(std::u32string(U"\uFEFF" TEST_STRING), order::little);
+        REQUIRE(decode_any<char32_t>(bytes) == expected);
+    }
+
+    SECTION("...to other encodings") {
+        const auto bytes = to_bytes(std::u32string(U"\uFEFF" TEST_STRING), order::big);
+        REQUIRE(decode_any<char16_t>(bytes) == u"" TEST_STRING);
+    }
+
+    SECTION("...with a function object") {
+        const std::string bytes = u8"" TEST_STRING;
+        const auto n = decode_any(bytes, [](auto&& view) {
+            return ranges::distance(view);
+        });
+        REQUIRE(n == static_cast<std::ptrdiff_t>(expected.size()));
+    }
+
+    SECTION("...for temporary ranges") {
+        const auto bytes = to_bytes(std::u16string(u"\uFEFF" TEST_STRING), order::big);
+        REQUIRE(decode_any<char32_t>(std::string(bytes)) == expected);
+        REQUIRE(decode_any<char32_t>(std::list<char>(bytes.begin(), bytes.end())) == expected);
+    }
+}
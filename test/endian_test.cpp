@@ -5,7 +5,12 @@
 
 #include "catch.hpp"
 
+#include <tcb/utf_ranges/endian.hpp>
 #include <tcb/utf_ranges/view/endian_convert.hpp>
+#include <tcb/utf_ranges/view/from_bytes.hpp>
+
+#include <iterator>
+#include <list>
 
 const auto to_little_endian = [] (const auto& in) {
     using char_type = ranges::range_value_t<decltype(in)>;
@@ -280,4 +285,157 @@ TEST_CASE("Byte swap big-to-big works", "[endian]")
                                                              order::big);
         REQUIRE(test == test_stringwb);
     }
-}
\ No newline at end of file
+}
+
+TEST_CASE("Compile-time byte swapping works", "[endian]")
+{
+    SECTION("...for UTF-16") {
+        const std::u16string test = endian_convert<order::native, order::big>(test_string16n);
+        REQUIRE(test == test_string16b);
+    }
+
+    SECTION("...for UTF-32") {
+        const std::u32string test = test_string32l | endian_convert<order::little, order::big>;
+        REQUIRE(test == test_string32b);
+    }
+
+    SECTION("... for wide chars") {
+        const std::wstring test = endian_convert<order::big, order::little>(test_stringwb);
+        REQUIRE(test == test_stringwl);
+    }
+}
+
+TEST_CASE("Compile-time no-op byte swaps collapse to the original range", "[endian]")
+{
+    const auto v = endian_convert<order::big, order::big>(test_string16b);
+
+    static_assert(std::is_same<decltype(v),
+                      const ranges::iterator_range<const char16_t*>>::value, "");
+    REQUIRE(std::u16string(v) == test_string16b);
+
+    const auto v8 = endian_convert<order::little, order::big>(test_string8n);
+    static_assert(std::is_same<decltype(v8),
+                      const ranges::iterator_range<const char*>>::value, "");
+}
+
+TEST_CASE("Nested endian conversions collapse to a single view", "[endian]")
+{
+    SECTION("...at run time") {
+        const auto v = endian_convert<order::little>(
+                endian_convert<order::big>(test_string16n), order::big);
+        static_assert(std::is_same<decltype(v),
+                          const tcb::utf_ranges::endian_convert_view<
+                              ranges::iterator_range<const char16_t*>, order::little>>::value, "");
+        REQUIRE(std::u16string(v) == test_string16l);
+    }
+
+    SECTION("...when the swaps cancel out") {
+        const auto v = endian_convert<order::big>(
+                endian_convert<order::big>(test_string16l, order::little), order::little);
+        REQUIRE_FALSE(v.needs_swap());
+        REQUIRE(std::u16string(v) == test_string16l);
+    }
+
+    SECTION("...at compile time") {
+        const auto v = endian_convert<order::little, order::big>(
+                endian_convert<order::big, order::little>(test_string16b));
+        static_assert(std::is_same<decltype(v),
+                          const ranges::iterator_range<const char16_t*>>::value, "");
+        REQUIRE(std::u16string(v) == test_string16b);
+    }
+
+    SECTION("...mixing the two") {
+        const auto v = endian_convert<order::big>(
+                endian_convert<order::big, order::little>(test_string16b), order::little);
+        REQUIRE_FALSE(v.needs_swap());
+        REQUIRE(std::u16string(v) == test_string16b);
+    }
+}
+
+// Long enough to exercise the vectorised paths as well as the scalar tail
+const std::u16string long_string16n = u"The quick brown fox jumps over the lazy dog, \u00e9\u4f60\u597d";
+const std::u32string long_string32n = U"The quick brown fox jumps over the lazy dog, \u00e9\u4f60\u597d";
+const std::u16string long_string16b = to_big_endian(long_string16n);
+const std::u32string long_string32b = to_big_endian(long_string32n);
+
+using tcb::utf_ranges::endian_convert_copy;
+using tcb::utf_ranges::endian_convert_inplace;
+
+TEST_CASE("In-place byte swapping works", "[endian]")
+{
+    SECTION("...for UTF-16") {
+        std::u16string test = long_string16n;
+        endian_convert_inplace<order::big>(test);
+        REQUIRE(test == long_string16b);
+        endian_convert_inplace(test, order::big);
+        REQUIRE(test == long_string16n);
+    }
+
+    SECTION("...for UTF-32") {
+        std::u32string test = long_string32n;
+        endian_convert_inplace<order::big>(test);
+        REQUIRE(test == long_string32b);
+    }
+}
+
+TEST_CASE("Bulk byte swapping copies work", "[endian]")
+{
+    SECTION("...from contiguous ranges to pointers") {
+        std::u16string test(long_string16n.size(), u'\0');
+        endian_convert_copy<order::big>(long_string16n, &test[0]);
+        REQUIRE(test == long_string16b);
+    }
+
+    SECTION("...from contiguous ranges to other iterators") {
+        std::u32string test;
+        endian_convert_copy<order::native>(long_string32b, std::back_inserter(test),
+                                           order::big);
+        REQUIRE(test == long_string32n);
+    }
+
+    SECTION("...from endian_convert views") {
+        std::u16string test;
+        endian_convert_copy<order::native>(endian_convert<order::big>(long_string16n),
+                                           std::back_inserter(test), order::big);
+        REQUIRE(test == long_string16n);
+    }
+
+    SECTION("...from non-contiguous ranges") {
+        const std::list<char16_t> list(long_string16n.begin(), long_string16n.end());
+        std::u16string test;
+        endian_convert_copy<order::big>(list, std::back_inserter(test));
+        REQUIRE(test == long_string16b);
+    }
+}
+
+TEST_CASE("Bulk byte swapping copies work from from_bytes views", "[endian]")
+{
+    // Big-endian UTF-16 bytes, long enough to need several passes through
+    // the copy buffer
+    std::u16string big;
+    for (int i = 0; i < 100; i++) {
+        big += long_string16b;
+    }
+    const std::string bytes(reinterpret_cast<const char*>(big.data()),
+                            big.size() * sizeof(char16_t));
+
+    std::u16string expected;
+    for (int i = 0; i < 100; i++) {
+        expected += long_string16n;
+    }
+
+    SECTION("...to native order") {
+        std::u16string test;
+        endian_convert_copy(tcb::utf_ranges::view::from_bytes<char16_t>(bytes, order::big),
+                            std::back_inserter(test));
+        REQUIRE(test == expected);
+    }
+
+    SECTION("...back to the source order") {
+        std::u16string test;
+        endian_convert_copy<order::big>(
+                tcb::utf_ranges::view::from_bytes<char16_t>(bytes, order::big),
+                std::back_inserter(test));
+        REQUIRE(test == big);
+    }
+}
@@ -0,0 +1,188 @@
+// Copyright (c) 2016 Tristan Brindle (tcbrindle at gmail dot com)
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include "catch.hpp"
+#include "to_bytes.hpp"
+
+#include <tcb/utf_ranges/istreambuf_range.hpp>
+#include <tcb/utf_ranges/view/bom.hpp>
+#include <tcb/utf_ranges/view/bytes.hpp>
+#include <tcb/utf_ranges/view/from_bytes.hpp>
+
+#include <sstream>
+
+#define TEST_STRING "$€0123456789你好abcdefghijklmnopqrstyvwxyz\U0001F60E"
+
+using namespace tcb::utf_ranges;
+using boost::endian::order;
+
+using test::to_bytes;
+
+TEST_CASE("from_bytes is the inverse of bytes", "[from_bytes]")
+{
+    const std::u16string str = u"" TEST_STRING;
+    const std::string bytes = str | view::bytes;
+    const std::u16string test = bytes | view::from_bytes<char16_t>;
+    REQUIRE(test == str);
+}
+
+TEST_CASE("from_bytes reassembles code units in the given byte order", "[from_bytes]")
+{
+    SECTION("...for UTF-16BE") {
+        const std::u16string str = u"" TEST_STRING;
+        const std::string bytes = to_bytes(str, order::big);
+        const std::u16string test = view::from_bytes<char16_t>(bytes, order::big);
+        REQUIRE(test == str);
+    }
+
+    SECTION("...for UTF-16LE") {
+        const std::u16string str = u"" TEST_STRING;
+        const std::string bytes = to_bytes(str, order::little);
+        const std::u16string test = bytes | view::from_bytes<char16_t>(order::little);
+        REQUIRE(test == str);
+    }
+
+    SECTION("...for UTF-32BE") {
+        const std::u32string str = U"" TEST_STRING;
+        const std::string bytes = to_bytes(str, order::big);
+        const std::u32string test = view::from_bytes<char32_t>(bytes, order::big);
+        REQUIRE(test == str);
+    }
+
+    SECTION("...for UTF-32LE") {
+        const std::u32string str = U"" TEST_STRING;
+        const std::string bytes = to_bytes(str, order::little);
+        const std::u32string test = view::from_bytes<char32_t>(bytes, order::little);
+        REQUIRE(test == str);
+    }
+}
+
+TEST_CASE("from_bytes can fix the byte order at compile time", "[from_bytes]")
+{
+    SECTION("...for UTF-16BE") {
+        const std::u16string str = u"" TEST_STRING;
+        const std::string bytes = to_bytes(str, order::big);
+        const auto v = view::from_bytes<char16_t, order::big>(bytes);
+        static_assert(std::is_same<decltype(v),
+                          const from_bytes_view<rng::iterator_range<const unsigned char*>,
+                                                char16_t, detail::swap_mode::always>>::value, "");
+        REQUIRE(std::u16string(v) == str);
+    }
+
+    SECTION("...for native UTF-32") {
+        const std::u32string str = U"" TEST_STRING;
+        const std::string bytes = to_bytes(str, order::native);
+        const std::u32string test = bytes | view::from_bytes<char32_t, order::native>;
+        REQUIRE(test == str);
+    }
+
+    SECTION("...for InputRanges of UTF-16LE") {
+        const std::u16string str = u"" TEST_STRING;
+        std::istringstream ss{to_bytes(str, order::little)};
+        const std::u16string test = istreambuf(ss) | view::from_bytes<char16_t, order::little>;
+        REQUIRE(test == str);
+    }
+
+    SECTION("...and still consume a BOM") {
+        const std::u16string str = u"" TEST_STRING;
+        const std::string bytes = to_bytes(u"\uFEFF" + str, order::little);
+        const std::u16string test = bytes | view::from_bytes<char16_t, order::big>
+                                          | view::consume_bom;
+        REQUIRE(test == str);
+    }
+}
+
+TEST_CASE("from_bytes is random-access over contiguous bytes", "[from_bytes]")
+{
+    const std::u16string str = u"" TEST_STRING;
+    const std::string bytes = to_bytes(str, order::big);
+    const auto v = view::from_bytes<char16_t>(bytes, order::big);
+
+    static_assert(rng::RandomAccessRange<decltype(v)>(), "");
+    static_assert(rng::SizedRange<decltype(v)>(), "");
+    REQUIRE(rng::size(v) == str.size());
+    REQUIRE(v[3] == str[3]);
+}
+
+TEST_CASE("from_bytes ignores incomplete trailing code units", "[from_bytes]")
+{
+    const std::u32string str = U"" TEST_STRING;
+    const std::string bytes = to_bytes(str, order::big) + "\x01\x02";
+    const std::u32string test = view::from_bytes<char32_t>(bytes, order::big);
+    REQUIRE(test == str);
+}
+
+TEST_CASE("from_bytes works with InputRanges", "[from_bytes]")
+{
+    const std::u16string str = u"" TEST_STRING;
+    std::istringstream ss{to_bytes(str, order::big)};
+    const std::u16string test = istreambuf(ss) | view::from_bytes<char16_t>(order::big);
+    REQUIRE(test == str);
+}
+
+TEST_CASE("consume_bom selects the byte order for from_bytes", "[from_bytes]")
+{
+    const std::u16string str = u"" TEST_STRING;
+
+    SECTION("...for contiguous UTF-16BE") {
+        const std::string bytes = to_bytes(u"\uFEFF" + str, order::big);
+        const std::u16string test = bytes | view::from_bytes<char16_t>
+                                          | view::consume_bom;
+        REQUIRE(test == str);
+    }
+
+    SECTION("...for contiguous UTF-16LE") {
+        const std::string bytes = to_bytes(u"\uFEFF" + str, order::little);
+        const std::u16string test = bytes | view::from_bytes<char16_t>
+                                          | view::consume_bom;
+        REQUIRE(test == str);
+    }
+
+    SECTION("...for contiguous bytes without a BOM") {
+        const std::string bytes = to_bytes(str, order::native);
+        const std::u16string test = bytes | view::from_bytes<char16_t>
+                                          | view::consume_bom;
+        REQUIRE(test == str);
+    }
+
+    SECTION("...for an InputRange of UTF-32BE") {
+        const std::u32string str32 = U"" TEST_STRING;
+        std::istringstream ss{to_bytes(U"\uFEFF" + str32, order::big)};
+        const std::u32string test = istreambuf(ss) | view::from_bytes<char32_t>
+                                                   | view::consume_bom;
+        REQUIRE(test == str32);
+    }
+}
+
+TEST_CASE("consume_bom overrides the requested byte order for contiguous from_bytes", "[from_bytes]")
+{
+    const std::u16string str16 = u"" TEST_STRING;
+    const std::u32string str32 = U"" TEST_STRING;
+
+    for (const order requested : {order::big, order::little}) {
+        for (const order bom_order : {order::big, order::little}) {
+            const std::string bytes16 = to_bytes(u"\uFEFF" + str16, bom_order);
+            const std::u16string test16 = view::from_bytes<char16_t>(bytes16, requested)
+                                          | view::consume_bom;
+            REQUIRE(test16 == str16);
+
+            const std::string bytes32 = to_bytes(U"\uFEFF" + str32, bom_order);
+            const std::u32string test32 = view::from_bytes<char32_t>(bytes32, requested)
+                                          | view::consume_bom;
+            REQUIRE(test32 == str32);
+        }
+    }
+
+    SECTION("...with the byte order fixed at compile time") {
+        const std::string little = to_bytes(u"\uFEFF" + str16, order::little);
+        const std::u16string test_little = little | view::from_bytes<char16_t, order::big>
+                                                  | view::consume_bom;
+        REQUIRE(test_little == str16);
+
+        const std::string big = to_bytes(u"\uFEFF" + str16, order::big);
+        const std::u16string test_big = big | view::from_bytes<char16_t, order::little>
+                                            | view::consume_bom;
+        REQUIRE(test_big == str16);
+    }
+}
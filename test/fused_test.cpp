@@ -0,0 +1,136 @@
+// Copyright (c) 2016 Tristan Brindle (tcbrindle at gmail dot com)
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include "catch.hpp"
+
+#include <tcb/utf_ranges/convert.hpp>
+#include <tcb/utf_ranges/fused.hpp>
+#include <tcb/utf_ranges/view.hpp>
+
+#include <range/v3/algorithm/copy.hpp>
+
+#include <iterator>
+#include <list>
+#include <string>
+#include <vector>
+
+namespace rng = ::ranges::v3;
+namespace utf = tcb::utf_ranges;
+using boost::endian::order;
+
+namespace {
+
+// Long enough to need several chunks, with multi-byte sequences falling
+// across chunk boundaries
+std::string make_test_string()
+{
+    std::string str;
+    for (int i = 0; i < 500; i++) {
+        str += u8"Hello é你\U0001F60E\r\n";
+    }
+    return str;
+}
+
+template <typename View>
+std::vector<rng::range_value_t<View>> elementwise(View& view)
+{
+    std::vector<rng::range_value_t<View>> out;
+    ranges::copy(view, std::back_inserter(out));
+    return out;
+}
+
+template <typename View>
+std::vector<rng::range_value_t<View>> fused(View& view)
+{
+    std::vector<rng::range_value_t<View>> out;
+    utf::fused_copy(view, std::back_inserter(out));
+    return out;
+}
+
+}
+
+TEST_CASE("fused_copy matches element-wise copy for the README pipeline", "[fused]")
+{
+    const std::string str = u8"\uFEFF" + make_test_string();
+
+    auto view = str
+            | utf::view::consume_bom
+            | utf::view::utf16
+            | utf::view::add_bom
+            | utf::view::endian_convert<order::big>
+            | utf::view::bytes;
+
+    const auto out = fused(view);
+    REQUIRE(out == elementwise(view));
+    REQUIRE(out.size() > 2);
+    REQUIRE(out[0] == 0xFE);
+    REQUIRE(out[1] == 0xFF);
+}
+
+TEST_CASE("fused_copy matches element-wise copy for transcoding and line ends", "[fused]")
+{
+    const std::u16string str = utf::to_u16string(make_test_string());
+
+    auto view = utf::view::line_end_transform(utf::view::utf8(str), utf::line_end::lf);
+
+    REQUIRE(fused(view) == elementwise(view));
+}
+
+TEST_CASE("fused_copy handles invalid and truncated input identically", "[fused]")
+{
+    const std::string str = make_test_string() + "\xE2\x28\xA1\xC0\xAF\xF0\x9F";
+
+    auto view = utf::view::utf16(str);
+
+    REQUIRE(fused(view) == elementwise(view));
+}
+
+TEST_CASE("fused_copy matches element-wise copy for long runs of ASCII", "[fused]")
+{
+    // Runs longer than a chunk, as well as short ones
+    std::string str;
+    for (int i = 0; i < 20; i++) {
+        str += std::string(static_cast<std::size_t>(i * 150), 'a') + u8"你" + "\xFF";
+    }
+
+    auto to_utf16 = utf::view::utf16(str);
+    REQUIRE(fused(to_utf16) == elementwise(to_utf16));
+
+    auto to_utf32 = utf::view::utf32(str);
+    REQUIRE(fused(to_utf32) == elementwise(to_utf32));
+
+    const std::u32string u32 = utf::to_u32string(str);
+    auto to_utf8 = utf::view::utf8(u32);
+    REQUIRE(fused(to_utf8) == elementwise(to_utf8));
+}
+
+TEST_CASE("fused_copy works with non-contiguous sources", "[fused]")
+{
+    const std::string str = make_test_string();
+    const std::list<char> list(str.begin(), str.end());
+
+    auto view = utf::view::utf32(list) | utf::view::endian_convert<order::little>;
+
+    REQUIRE(fused(view) == elementwise(view));
+}
+
+TEST_CASE("fused_copy works with from_bytes sources", "[fused]")
+{
+    const std::u16string units = utf::to_u16string(make_test_string());
+    const auto bytes = utf::view::bytes(units);
+    std::string raw;
+    ranges::copy(bytes, std::back_inserter(raw));
+
+    auto view = utf::view::utf8(utf::view::from_bytes<char16_t>(raw));
+
+    REQUIRE(fused(view) == elementwise(view));
+}
+
+TEST_CASE("fused_copy copies plain ranges", "[fused]")
+{
+    const std::string str = "Hello world";
+    std::string out;
+    utf::fused_copy(str, std::back_inserter(out));
+    REQUIRE(out == str);
+}
@@ -5,10 +5,18 @@
 
 #include "catch.hpp"
 
+#include <tcb/utf_ranges/istreambuf_range.hpp>
+#include <tcb/utf_ranges/line_end.hpp>
 #include <tcb/utf_ranges/view.hpp>
 
+#include <range/v3/algorithm/copy.hpp>
 #include <range/v3/algorithm/count_if.hpp>
 
+#include <algorithm>
+#include <iterator>
+#include <list>
+#include <sstream>
+
 #define TEST_STRING "\n \r \r\n \u0085 \u000b \u000c \u2028 \u2029"
 
 TEST_CASE("Line end transformations work as expected", "[line_end]")
@@ -20,4 +28,154 @@ TEST_CASE("Line end transformations work as expected", "[line_end]")
     static_assert(ranges::ForwardRange<decltype(v)>(), "");
 
     REQUIRE(ranges::count_if(v, [](char c) { return c == '\n'; }) == 8);
-}
\ No newline at end of file
+}
+
+TEST_CASE("Line end transformations work on native code units", "[line_end]")
+{
+    namespace utf = tcb::utf_ranges;
+
+    SECTION("UTF-8")
+    {
+        const std::string str = u8"a\r\nb c©d‰e\u0085";
+        const std::string out = utf::view::line_end_transform(str);
+        REQUIRE(out == u8"a\nb\nc©d‰e\n");
+    }
+
+    SECTION("UTF-16")
+    {
+        const std::u16string str = u"a\r\nb c©d\r";
+        const std::u16string out = str | utf::view::line_end_transform;
+        REQUIRE(out == u"a\nb\nc©d\n");
+    }
+
+    SECTION("UTF-32")
+    {
+        const std::u32string str = U"a\u000bb\u000cc\U0001F600\r\n";
+        const std::u32string out = utf::view::line_end_transform(str);
+        REQUIRE(out == U"a\nb\nc\U0001F600\n");
+    }
+
+    SECTION("Truncated UTF-8 sequences are passed through")
+    {
+        const std::string str = "ab\xE2\x80";
+        const std::string out = utf::view::line_end_transform(str);
+        REQUIRE(out == str);
+    }
+
+    SECTION("Non-contiguous input")
+    {
+        const std::list<char> list{'a', '\r', '\n', 'b', '\r'};
+        const std::string out = utf::view::line_end_transform(list);
+        REQUIRE(out == "a\nb\n");
+    }
+}
+
+TEST_CASE("transform_line_ends() matches the line_end_transform view", "[line_end]")
+{
+    namespace utf = tcb::utf_ranges;
+
+    // Long enough that the vectorised scan sees several whole blocks
+    std::string str;
+    for (int i = 0; i < 20; i++) {
+        str += u8"Some clean text which is longer than a block" TEST_STRING u8"©";
+    }
+
+    std::string out;
+    utf::transform_line_ends(str, std::back_inserter(out));
+    const std::string expected = utf::view::line_end_transform(str);
+    REQUIRE(out == expected);
+    REQUIRE(std::count(out.begin(), out.end(), '\n') == 8 * 20);
+
+    std::u16string str16 = u"x\r\ny" TEST_STRING;
+    std::u16string out16(str16.size(), u'\0');
+    auto last = utf::transform_line_ends(str16, &out16[0]);
+    out16.resize(last - out16.data());
+    const std::u16string expected16 = utf::view::line_end_transform(str16);
+    REQUIRE(out16 == expected16);
+
+    const std::list<char> list{'a', '\r', '\n', 'b'};
+    std::string list_out;
+    utf::transform_line_ends(list, std::back_inserter(list_out));
+    REQUIRE(list_out == "a\nb");
+}
+
+TEST_CASE("Line endings can be converted to a chosen target", "[line_end]")
+{
+    namespace utf = tcb::utf_ranges;
+
+    const std::string str = u8"a\nb\r\nc\rd ";
+
+    SECTION("LF")
+    {
+        const std::string out = utf::view::line_end_transform(str, utf::line_end::lf);
+        REQUIRE(out == "a\nb\nc\nd\n");
+    }
+
+    SECTION("CRLF")
+    {
+        const std::string out = utf::view::line_end_transform(str, utf::line_end::crlf);
+        REQUIRE(out == "a\r\nb\r\nc\r\nd\r\n");
+    }
+
+    SECTION("CR")
+    {
+        const std::string out = utf::view::line_end_transform(str, utf::line_end::cr);
+        REQUIRE(out == "a\rb\rc\rd\r");
+    }
+
+    SECTION("Preserve")
+    {
+        const std::string out = utf::view::line_end_transform(str, utf::line_end::preserve);
+        REQUIRE(out == str);
+    }
+
+    SECTION("UTF-16 to CRLF")
+    {
+        const std::u16string str16 = u"a\nb\u0085";
+        const std::u16string out = utf::view::line_end_transform(str16, utf::line_end::crlf);
+        REQUIRE(out == u"a\r\nb\r\n");
+    }
+
+    SECTION("Eager")
+    {
+        std::string out;
+        utf::transform_line_ends(str, std::back_inserter(out), utf::line_end::crlf);
+        REQUIRE(out == "a\r\nb\r\nc\r\nd\r\n");
+    }
+}
+
+TEST_CASE("line_end_transform works with single-pass input", "[line_end]")
+{
+    namespace utf = tcb::utf_ranges;
+
+    std::istringstream ss{"a\r\nb\rc\r"};
+    auto v = utf::view::line_end_transform(utf::istreambuf(ss), utf::line_end::crlf);
+
+    static_assert(ranges::InputRange<decltype(v)>(), "");
+
+    std::string out;
+    ranges::copy(v, std::back_inserter(out));
+    REQUIRE(out == "a\r\nb\r\nc\r\n");
+}
+
+TEST_CASE("line_end_transformer gives the same result for any chunking", "[line_end]")
+{
+    namespace utf = tcb::utf_ranges;
+
+    const std::string str = u8"abc\r\ndef\rghi\u0085jkl ©\xE2\x80x\r";
+    const std::string expected = u8"abc\r\ndef\r\nghi\r\njkl\r\n©\xE2\x80x\r\n";
+
+    for (std::size_t chunk = 1; chunk <= str.size(); chunk++) {
+        utf::line_end_transformer<char> transformer{utf::line_end::crlf};
+        std::string out;
+
+        for (std::size_t i = 0; i < str.size(); i += chunk) {
+            const std::size_t len = std::min(chunk, str.size() - i);
+            transformer.transform(str.data() + i, str.data() + i + len,
+                                  std::back_inserter(out));
+        }
+        transformer.flush(std::back_inserter(out));
+
+        REQUIRE(out == expected);
+    }
+}
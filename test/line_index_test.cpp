@@ -0,0 +1,179 @@
+// Copyright (c) 2016 Tristan Brindle (tcbrindle at gmail dot com)
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include "catch.hpp"
+
+#include <tcb/utf_ranges/line_index.hpp>
+
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace utf = tcb::utf_ranges;
+using utf::position_unit;
+using utf::text_position;
+
+TEST_CASE("line_index finds every kind of line terminator", "[line_index]")
+{
+    const std::string text = u8"a\nb\rc\r\nd\ve\ff\u0085g\u2028h\u2029i";
+    const utf::line_index index{text};
+
+    REQUIRE(index.num_lines() == 9);
+    for (std::size_t i = 0; i < index.num_lines(); i++) {
+        const std::size_t start = index.line_start(i);
+        REQUIRE(index.line_end(i) == start + 1);
+        REQUIRE(text[start] == static_cast<char>('a' + i));
+    }
+    REQUIRE(index.line_start(2) == 4);
+    REQUIRE(index.line_start(3) == 7);
+    REQUIRE(index.line_end(8) == text.size());
+}
+
+TEST_CASE("line_index handles empty text and trailing terminators", "[line_index]")
+{
+    const std::string empty;
+    const utf::line_index empty_index{empty};
+    REQUIRE(empty_index.num_lines() == 1);
+    REQUIRE(empty_index.position_of(0) == (text_position{0, 0}));
+    REQUIRE(empty_index.offset_of({3, 4}) == 0);
+
+    const std::string text = "one\r\ntwo\r\n";
+    const utf::line_index index{text};
+    REQUIRE(index.num_lines() == 3);
+    REQUIRE(index.line_end(1) == 8);
+    REQUIRE(index.line_start(2) == 10);
+    REQUIRE(index.position_of(10) == (text_position{2, 0}));
+}
+
+TEST_CASE("line_index does not split CRLF or other multi-unit terminators", "[line_index]")
+{
+    const std::string text = u8"ab\r\ncd\u2028";
+    const utf::line_index index{text};
+    REQUIRE(index.num_lines() == 3);
+    REQUIRE(index.line_end(0) == 2);
+    REQUIRE(index.line_end(1) == 6);
+
+    // Offsets within a terminator belong to the line it ends
+    REQUIRE(index.position_of(3) == (text_position{0, 3}));
+    REQUIRE(index.position_of(8) == (text_position{1, 4}));
+}
+
+TEST_CASE("line_index converts positions with columns in each unit", "[line_index]")
+{
+    // "\U0001F60E" is 4 bytes, 2 UTF-16 units and 1 code point
+    const std::string text = u8"first\nxé\U0001F60Ey\nlast";
+    const utf::line_index index{text};
+    REQUIRE(index.num_lines() == 3);
+
+    const std::size_t y = text.find('y');
+    REQUIRE(index.position_of(y) == (text_position{1, 7}));
+    REQUIRE(index.position_of(y, position_unit::utf16) == (text_position{1, 4}));
+    REQUIRE(index.position_of(y, position_unit::code_point) == (text_position{1, 3}));
+
+    REQUIRE(index.offset_of({1, 7}) == y);
+    REQUIRE(index.offset_of({1, 4}, position_unit::utf16) == y);
+    REQUIRE(index.offset_of({1, 3}, position_unit::code_point) == y);
+
+    // The last line has no terminator
+    REQUIRE(index.position_of(text.size(), position_unit::code_point) == (text_position{2, 4}));
+}
+
+TEST_CASE("line_index clamps positions to the text", "[line_index]")
+{
+    const std::string text = u8"éé\nz";
+    const utf::line_index index{text};
+
+    REQUIRE(index.offset_of({0, 100}) == 4);
+    REQUIRE(index.offset_of({0, 100}, position_unit::utf16) == 4);
+    REQUIRE(index.offset_of({0, 100}, position_unit::code_point) == 4);
+    REQUIRE(index.offset_of({1, 100}) == text.size());
+    REQUIRE(index.offset_of({5, 0}) == text.size());
+    REQUIRE(index.position_of(100) == (text_position{1, 1}));
+
+    // A byte offset in the middle of a code point gives the column of that
+    // code point, in other units
+    REQUIRE(index.position_of(1, position_unit::code_point) == (text_position{0, 0}));
+}
+
+TEST_CASE("line_index finds terminators in long text", "[line_index]")
+{
+    std::string text;
+    for (int i = 0; i < 1000; i++) {
+        text += std::string(static_cast<std::size_t>(i % 37), 'a');
+        text += i % 2 ? u8"é\n" : u8"\u2029";
+    }
+    const utf::line_index index{text};
+    REQUIRE(index.num_lines() == 1001);
+
+    std::size_t offset = 0;
+    for (std::size_t i = 0; i < 1000; i++) {
+        REQUIRE(index.line_start(i) == offset);
+        const std::size_t length = i % 37 + (i % 2 ? 2 : 0);
+        REQUIRE(index.line_end(i) == offset + length);
+        REQUIRE(index.position_of(offset + length, position_unit::code_point) ==
+                (text_position{i, i % 37 + i % 2}));
+        REQUIRE(index.offset_of({i, i % 37 + i % 2}, position_unit::utf16) == offset + length);
+        offset += length + (i % 2 ? 1 : 3);
+    }
+}
+
+TEST_CASE("u16_line_index measures columns in UTF-16 units", "[line_index]")
+{
+    const std::u16string text = u"a\u2028\U0001F60Eb\u0085c";
+    const utf::u16_line_index index{text};
+    REQUIRE(index.num_lines() == 3);
+    REQUIRE(index.line_start(1) == 2);
+    REQUIRE(index.line_end(1) == 5);
+
+    REQUIRE(index.position_of(4) == (text_position{1, 2}));
+    REQUIRE(index.position_of(4, position_unit::utf8) == (text_position{1, 4}));
+    REQUIRE(index.position_of(4, position_unit::code_point) == (text_position{1, 1}));
+    REQUIRE(index.offset_of({1, 4}, position_unit::utf8) == 4);
+    REQUIRE(index.offset_of({2, 0}) == 6);
+}
+
+TEST_CASE("Copies of a line_index give the same positions", "[line_index]")
+{
+    const std::string text = u8"é\n\U0001F60Ez";
+    const utf::line_index index{text};
+
+    // Before and after the original has built its column map
+    const utf::line_index before = index;
+    REQUIRE(index.position_of(7, position_unit::utf16) == (text_position{1, 2}));
+    const utf::line_index after = index;
+
+    REQUIRE(before.position_of(7, position_unit::utf16) == (text_position{1, 2}));
+    REQUIRE(after.offset_of({1, 1}, position_unit::code_point) == 7);
+    REQUIRE(after.position_of(7) == (text_position{1, 4}));
+}
+
+TEST_CASE("line_index can be used from several threads at once", "[line_index]")
+{
+    std::string text;
+    for (int i = 0; i < 200; i++) {
+        text += u8"é\U0001F60Ex\n";
+    }
+    const utf::line_index index{text};
+    const utf::line_index copy = index;
+
+    // None of the threads finds the column map built; each checks every line
+    std::vector<int> failures(8);
+    std::vector<std::thread> threads;
+    for (std::size_t t = 0; t < failures.size(); t++) {
+        const utf::line_index& which = t % 2 ? copy : index;
+        threads.emplace_back([&which, &failures, t] {
+            for (std::size_t line = 0; line < 200; line++) {
+                const std::size_t x = line * 8 + 6;
+                failures[t] += which.position_of(x, position_unit::utf16) !=
+                               (text_position{line, 3});
+                failures[t] += which.offset_of({line, 2}, position_unit::code_point) != x;
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    REQUIRE(failures == std::vector<int>(8, 0));
+}
@@ -0,0 +1,97 @@
+// Copyright (c) 2016 Tristan Brindle (tcbrindle at gmail dot com)
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include "catch.hpp"
+
+#include <tcb/utf_ranges/view/lines.hpp>
+
+#include <range/v3/distance.hpp>
+
+#include <string>
+#include <vector>
+
+namespace utf = tcb::utf_ranges;
+
+TEST_CASE("lines splits on all Unicode line terminators", "[lines]")
+{
+    const std::string str = u8"one\ntwo\r\nthree\rfour\u0085five six seven\vé\f\r\n©end";
+
+    auto v = utf::view::lines(str);
+
+    static_assert(ranges::ForwardRange<decltype(v)>(), "");
+    REQUIRE(ranges::distance(v) == 10);
+
+    std::vector<std::string> text;
+    std::vector<utf::line_terminator> terminators;
+    for (auto line : v) {
+        text.push_back(line.str());
+        terminators.push_back(line.terminator());
+    }
+
+    const std::vector<std::string> expected_text{
+        "one", "two", "three", "four", "five", "six", "seven", u8"é", "", u8"©end"
+    };
+    REQUIRE(text == expected_text);
+
+    const std::vector<utf::line_terminator> expected_terminators{
+        utf::line_terminator::lf, utf::line_terminator::crlf,
+        utf::line_terminator::cr, utf::line_terminator::nel,
+        utf::line_terminator::ls, utf::line_terminator::ps,
+        utf::line_terminator::vt, utf::line_terminator::ff,
+        utf::line_terminator::crlf, utf::line_terminator::none
+    };
+    REQUIRE(terminators == expected_terminators);
+}
+
+TEST_CASE("lines refers into the original string", "[lines]")
+{
+    const std::string str = "first line\nsecond line";
+
+    auto v = str | utf::view::lines;
+    auto it = ranges::begin(v);
+
+    REQUIRE((*it).data() == str.data());
+    REQUIRE((*it).size() == 10u);
+    ++it;
+    REQUIRE((*it).data() == str.data() + 11);
+    REQUIRE((*it).size() == 11u);
+}
+
+TEST_CASE("lines handles empty lines and trailing terminators", "[lines]")
+{
+    const std::string empty;
+    REQUIRE(ranges::distance(utf::view::lines(empty)) == 0);
+
+    const std::string one = "a\n";
+    REQUIRE(ranges::distance(utf::view::lines(one)) == 1);
+
+    const std::string blanks = "\n\n\n";
+    REQUIRE(ranges::distance(utf::view::lines(blanks)) == 3);
+    for (auto line : utf::view::lines(blanks)) {
+        REQUIRE(line.empty());
+    }
+
+    // A lone C2 or E2 80 is not a line ending
+    const std::string truncated = "a\xE2\x80";
+    auto v = utf::view::lines(truncated);
+    REQUIRE(ranges::distance(v) == 1);
+    REQUIRE((*ranges::begin(v)).size() == 3u);
+}
+
+TEST_CASE("lines works with UTF-16 and UTF-32", "[lines]")
+{
+    const std::u16string str16 = u"a\r\nb c";
+    std::vector<std::u16string> lines16;
+    for (auto line : utf::view::lines(str16)) {
+        lines16.push_back(line.str());
+    }
+    REQUIRE(lines16 == (std::vector<std::u16string>{u"a", u"b", u"c"}));
+
+    const std::u32string str32 = U"\U0001F600\n\u0085";
+    std::vector<std::u32string> lines32;
+    for (auto line : utf::view::lines(str32)) {
+        lines32.push_back(line.str());
+    }
+    REQUIRE(lines32 == (std::vector<std::u32string>{U"\U0001F600", U""}));
+}
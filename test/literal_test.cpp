@@ -0,0 +1,85 @@
+// Copyright (c) 2016 Tristan Brindle (tcbrindle at gmail dot com)
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include "catch.hpp"
+
+#include <tcb/utf_ranges/literal.hpp>
+
+#include <string>
+
+using tcb::utf_ranges::literal;
+
+#define TEST_STRING "Grüß Gott, 你好 \U0001F60E"
+
+// All of these are checked by the compiler
+static_assert(literal<char16_t>(u8"" TEST_STRING) == u"" TEST_STRING, "");
+static_assert(literal<char32_t>(u8"" TEST_STRING) == U"" TEST_STRING, "");
+static_assert(literal<char>(u"" TEST_STRING) == u8"" TEST_STRING, "");
+static_assert(literal<char32_t>(u"" TEST_STRING) == U"" TEST_STRING, "");
+static_assert(literal<char>(U"" TEST_STRING) == u8"" TEST_STRING, "");
+static_assert(literal<char16_t>(U"" TEST_STRING) == u"" TEST_STRING, "");
+
+TEST_CASE("Literals are converted at compile time", "[literal]")
+{
+    constexpr auto str = literal<char16_t>(u8"" TEST_STRING);
+
+    static_assert(str.size() == sizeof(u"" TEST_STRING) / sizeof(char16_t) - 1, "");
+    REQUIRE(str.str() == u"" TEST_STRING);
+    REQUIRE(std::u16string(str.begin(), str.end()) == u"" TEST_STRING);
+    REQUIRE(std::u16string(str.c_str()) == u"" TEST_STRING);
+}
+
+TEST_CASE("Literal capacity is enough for the worst case", "[literal]")
+{
+    // Each invalid byte becomes a three-byte U+FFFD
+    constexpr auto invalid = literal<char>(u8"\xFF\xFF");
+    static_assert(invalid == u8"\uFFFD\uFFFD", "");
+    static_assert(invalid.capacity() == 6, "");
+
+    // Supplementary characters go from one UTF-32 unit to four bytes
+    constexpr auto wide = literal<char>(U"\U0001F60E");
+    static_assert(wide == u8"\U0001F60E", "");
+    static_assert(wide.capacity() == 4, "");
+
+    // ...but UTF-8 to UTF-16 never needs more units than it started with
+    constexpr auto narrow = literal<char16_t>(u8"\U0001F60E");
+    static_assert(narrow.capacity() == 4, "");
+    static_assert(narrow.size() == 2, "");
+
+    REQUIRE(invalid.str() == u8"\uFFFD\uFFFD");
+}
+
+TEST_CASE("Literals can be stored with their exact length", "[literal]")
+{
+    using tcb::utf_ranges::basic_fixed_string;
+    using tcb::utf_ranges::converted_length;
+
+    static_assert(converted_length<char32_t>(u8"abc") == 3, "");
+    static_assert(converted_length<char>(U"\U0001F60E") == 4, "");
+    static_assert(converted_length<char16_t>(u8"" TEST_STRING) ==
+                  sizeof(u"" TEST_STRING) / sizeof(char16_t) - 1, "");
+    static_assert(converted_length<char>(u8"\xFF") == 3, "");
+
+    constexpr basic_fixed_string<char32_t, converted_length<char32_t>(u8"" TEST_STRING)>
+            str{u8"" TEST_STRING};
+    static_assert(str == U"" TEST_STRING, "");
+    static_assert(str.capacity() == str.size(), "");
+    REQUIRE(str.str() == U"" TEST_STRING);
+}
+
+TEST_CASE("Invalid literals are repaired", "[literal]")
+{
+    static_assert(literal<char32_t>(u8"a\xC0\xAF" "b\xE2\x28") == U"a\uFFFD\uFFFDb\uFFFD(", "");
+    static_assert(literal<char>(u"\xD800" "a") == u8"\uFFFDa", "");
+
+    REQUIRE(literal<char32_t>(u8"a\xC0\xAF").str() == U"a\uFFFD\uFFFD");
+}
+
+TEST_CASE("Empty literals give empty strings", "[literal]")
+{
+    constexpr auto empty = literal<char32_t>(u8"");
+    static_assert(empty.empty(), "");
+    REQUIRE(empty.str().empty());
+    REQUIRE(*empty.c_str() == U'\0');
+}
@@ -0,0 +1,185 @@
+// Copyright (c) 2016 Tristan Brindle (tcbrindle at gmail dot com)
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include "catch.hpp"
+
+#include <tcb/utf_ranges/position_map.hpp>
+
+#include <string>
+#include <vector>
+
+namespace utf = tcb::utf_ranges;
+using utf::position_unit;
+
+namespace {
+
+// Each code point of the text, in UTF-8 and UTF-16
+struct code_point {
+    std::string u8;
+    std::u16string u16;
+};
+
+const std::vector<code_point> alphabet = {
+    {u8"a", u"a"}, {u8"é", u"é"}, {u8"你", u"你"}, {u8"\U0001F60E", u"\U0001F60E"}, {u8"\n", u"\n"}
+};
+
+std::vector<code_point> make_text(std::size_t length)
+{
+    std::vector<code_point> text;
+    for (std::size_t i = 0; i < length; i++) {
+        text.push_back(alphabet[(i * 7 + i / 3) % alphabet.size()]);
+    }
+    return text;
+}
+
+template <typename CharT>
+std::basic_string<CharT> encode(const std::vector<code_point>& text);
+
+template <>
+std::string encode<char>(const std::vector<code_point>& text)
+{
+    std::string out;
+    for (const auto& c : text) {
+        out += c.u8;
+    }
+    return out;
+}
+
+template <>
+std::u16string encode<char16_t>(const std::vector<code_point>& text)
+{
+    std::u16string out;
+    for (const auto& c : text) {
+        out += c.u16;
+    }
+    return out;
+}
+
+// Checks every conversion from the start of every code point against the
+// text itself
+template <typename CharT>
+void check_map(const utf::basic_position_map<CharT>& map, const std::vector<code_point>& text)
+{
+    std::size_t u8 = 0;
+    std::size_t u16 = 0;
+    for (std::size_t cp = 0; cp <= text.size(); cp++) {
+        REQUIRE(map.convert(u8, position_unit::utf8, position_unit::utf16) == u16);
+        REQUIRE(map.convert(u8, position_unit::utf8, position_unit::code_point) == cp);
+        REQUIRE(map.convert(u16, position_unit::utf16, position_unit::utf8) == u8);
+        REQUIRE(map.convert(u16, position_unit::utf16, position_unit::code_point) == cp);
+        REQUIRE(map.convert(cp, position_unit::code_point, position_unit::utf8) == u8);
+        REQUIRE(map.convert(cp, position_unit::code_point, position_unit::utf16) == u16);
+
+        if (cp < text.size()) {
+            // Positions inside a code point map to its start
+            for (std::size_t i = 1; i < text[cp].u8.size(); i++) {
+                REQUIRE(map.convert(u8 + i, position_unit::utf8, position_unit::utf16) == u16);
+            }
+            u8 += text[cp].u8.size();
+            u16 += text[cp].u16.size();
+        }
+    }
+
+    REQUIRE(map.size(position_unit::utf8) == u8);
+    REQUIRE(map.size(position_unit::utf16) == u16);
+    REQUIRE(map.size(position_unit::code_point) == text.size());
+    REQUIRE(map.convert(u8 + 10, position_unit::utf8, position_unit::utf16) == u16);
+}
+
+template <typename CharT>
+std::size_t offset_of(const std::vector<code_point>& text, std::size_t n)
+{
+    return encode<CharT>({text.begin(), text.begin() + static_cast<std::ptrdiff_t>(n)}).size();
+}
+
+template <typename CharT>
+void check_edits()
+{
+    std::vector<code_point> text = make_text(200);
+    std::basic_string<CharT> str = encode<CharT>(text);
+    utf::basic_position_map<CharT> map{str, 16};
+    check_map(map, text);
+
+    struct edit {
+        std::size_t first;   // first code point to replace
+        std::size_t removed; // code points removed
+        std::size_t inserted;
+    };
+
+    // Within a block, across several blocks, at the very start and end,
+    // and removing everything
+    const std::vector<edit> edits = {
+        {10, 1, 1}, {20, 0, 5}, {30, 40, 2}, {0, 3, 0}, {0, 0, 50}, {5, 2, 60},
+        {100, 100, 0}, {0, 0, 0}
+    };
+
+    for (const edit& e : edits) {
+        const std::size_t first = std::min(e.first, text.size());
+        const std::size_t last = std::min(first + e.removed, text.size());
+
+        const std::size_t offset = offset_of<CharT>(text, first);
+        const std::size_t removed = offset_of<CharT>(text, last) - offset;
+
+        const std::vector<code_point> inserted = make_text(e.inserted);
+        text.erase(text.begin() + static_cast<std::ptrdiff_t>(first),
+                   text.begin() + static_cast<std::ptrdiff_t>(last));
+        text.insert(text.begin() + static_cast<std::ptrdiff_t>(first),
+                    inserted.begin(), inserted.end());
+
+        str = encode<CharT>(text);
+        map.update(str, offset, removed);
+        check_map(map, text);
+    }
+
+    text.clear();
+    str.clear();
+    map.update(str, 0, map.size(utf::basic_position_map<CharT>::native_unit));
+    check_map(map, text);
+
+    text = make_text(30);
+    str = encode<CharT>(text);
+    map.update(str, 0, 0);
+    check_map(map, text);
+}
+
+}
+
+TEST_CASE("position_map converts positions in UTF-8 text", "[position_map]")
+{
+    const std::vector<code_point> text = make_text(500);
+    const std::string str = encode<char>(text);
+
+    for (std::size_t block_size : {1, 3, 64, 1024}) {
+        check_map(utf::position_map{str, block_size}, text);
+    }
+}
+
+TEST_CASE("position_map converts positions in UTF-16 text", "[position_map]")
+{
+    const std::vector<code_point> text = make_text(500);
+    const std::u16string str = encode<char16_t>(text);
+
+    for (std::size_t block_size : {1, 3, 64, 1024}) {
+        check_map(utf::u16_position_map{str, block_size}, text);
+    }
+}
+
+TEST_CASE("position_map handles empty text", "[position_map]")
+{
+    const std::string str;
+    const utf::position_map map{str};
+
+    check_map(map, {});
+}
+
+TEST_CASE("position_map is updated incrementally after edits", "[position_map]")
+{
+    SECTION("UTF-8") {
+        check_edits<char>();
+    }
+
+    SECTION("UTF-16") {
+        check_edits<char16_t>();
+    }
+}
@@ -0,0 +1,31 @@
+// Copyright (c) 2016 Tristan Brindle (tcbrindle at gmail dot com)
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef TCB_UTF_RANGES_TEST_TO_BYTES_HPP_INCLUDED
+#define TCB_UTF_RANGES_TEST_TO_BYTES_HPP_INCLUDED
+
+#include <tcb/utf_ranges/view/from_bytes.hpp>
+
+#include <boost/endian/conversion.hpp>
+
+#include <string>
+
+namespace test {
+
+// Serialises str as a string of bytes in the given byte order
+template <typename CharT>
+std::string to_bytes(const std::basic_string<CharT>& str, boost::endian::order byte_order)
+{
+    std::string out;
+    for (CharT c : str) {
+        auto u = static_cast<tcb::utf_ranges::detail::uint_of_size_t<CharT>>(c);
+        u = boost::endian::conditional_reverse(u, boost::endian::order::native, byte_order);
+        out.append(reinterpret_cast<const char*>(&u), sizeof(u));
+    }
+    return out;
+}
+
+} // end namespace test
+
+#endif // TCB_UTF_RANGES_TEST_TO_BYTES_HPP_INCLUDED
@@ -5,9 +5,13 @@
 
 #include "catch.hpp"
 
+#include <tcb/utf_ranges/convert.hpp>
 #include <tcb/utf_ranges/view.hpp>
 #include <range/v3/algorithm/equal.hpp>
 
+#include <string>
+#include <type_traits>
+
 #if __has_include(<experimental/string_view>)
 #include <experimental/string_view>
 using std::experimental::string_view;
@@ -236,3 +240,75 @@ TEST_CASE("Non-character conversions work as expected", "[view]")
     REQUIRE(rng::equal(check, vec));
 }
 
+
+/*
+ * Invalid input
+ */
+
+TEST_CASE("Invalid UTF-8 is replaced by U+FFFD", "[view]")
+{
+    const std::string str = "a\xC0\xAF" "b\xE2\x28" "c\xF0\x9F";
+    const std::u32string check = U"a\uFFFD\uFFFDb\uFFFD(c\uFFFD";
+    const auto v = view::utf32(str);
+    REQUIRE(rng::equal(check, v));
+    REQUIRE(to_u32string(str) == check);
+}
+
+TEST_CASE("Each maximal subpart of invalid UTF-8 is replaced once", "[view]")
+{
+    SECTION("Surrogates") {
+        REQUIRE(to_u32string(std::string("\xED\xA0\x80")) == U"\uFFFD\uFFFD\uFFFD");
+    }
+
+    SECTION("Values above U+10FFFF") {
+        REQUIRE(to_u32string(std::string("\xF4\x90\x80\x80")) ==
+                U"\uFFFD\uFFFD\uFFFD\uFFFD");
+    }
+
+    SECTION("Overlong forms") {
+        REQUIRE(to_u32string(std::string("\xE0\x80\xAF")) == U"\uFFFD\uFFFD\uFFFD");
+    }
+
+    SECTION("Truncated sequences") {
+        REQUIRE(to_u32string(std::string("\xF0\x9F\x98" "a\xE2\x82")) ==
+                U"\uFFFDa\uFFFD");
+    }
+}
+
+TEST_CASE("Invalid UTF-16 is replaced by U+FFFD", "[view]")
+{
+    std::u16string str = u"a";
+    str += static_cast<char16_t>(0xDC00);
+    str += u'b';
+    str += static_cast<char16_t>(0xD800);
+    str += u'c';
+    str += static_cast<char16_t>(0xD800);
+    const std::string check = u8"a\uFFFDb\uFFFDc\uFFFD";
+    const auto v = view::utf8(str);
+    REQUIRE(rng::equal(check, v));
+}
+
+/*
+ * Nested conversions
+ */
+
+TEST_CASE("Nested conversion views collapse to a single conversion", "[view]")
+{
+    const std::string str = u8"" TEST_STRING;
+
+    const auto v = view::utf32(view::utf16(str));
+    static_assert(std::is_same<decltype(v),
+                               const decltype(view::utf32(str))>::value, "");
+    REQUIRE(rng::equal(std::u32string(U"" TEST_STRING), v));
+}
+
+TEST_CASE("UTF-8 -> UTF-16 -> UTF-8 is a validate-and-replace pass", "[view]")
+{
+    const std::string str = u8"" TEST_STRING "\xC0\xAF";
+    const std::string check = u8"" TEST_STRING "\uFFFD\uFFFD";
+
+    const auto v = view::utf8(view::utf16(str));
+    static_assert(std::is_same<decltype(v),
+                               const decltype(view::utf8(str))>::value, "");
+    REQUIRE(rng::equal(check, v));
+}